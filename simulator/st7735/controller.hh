@@ -1,19 +1,26 @@
+#ifndef DISPLAY_DRIVERS_SIMULATOR_ST7735_CONTROLLER_HH_
+#define DISPLAY_DRIVERS_SIMULATOR_ST7735_CONTROLLER_HH_
 
 #include <src/st7735/lcd_st7735.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <format>
 #include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
 #ifdef SIMULATOR_LOGGING
-#include <iostream>
 #define LOG(msg) std::cout << msg
 #else
 #define LOG(msg)                                                                                                       \
@@ -23,39 +30,13 @@
 
 namespace Simulator {
 
-// Forwward declaration
-template <size_t width, size_t height>
-class St7735;
-
-template <size_t width, size_t height>
-class State {
- public:
-  virtual ~State()                                                              = default;
-  virtual void handle(St7735<width, height>& sim, std::vector<uint8_t>& buffer) = 0;
-};
-
-template <size_t width, size_t height>
-class CommandState : public State<width, height> {
- public:
-  void handle(St7735<width, height>& sim, std::vector<uint8_t>& buffer) override { sim.parse_commands(buffer); }
-};
-
-template <size_t width, size_t height>
-class CasetState : public State<width, height> {
- public:
-  void handle(St7735<width, height>& sim, std::vector<uint8_t>& buffer) override { sim.parse_caset(buffer); }
-};
-
-template <size_t width, size_t height>
-class RasetState : public State<width, height> {
- public:
-  void handle(St7735<width, height>& sim, std::vector<uint8_t>& buffer) override { sim.parse_raset(buffer); }
-};
-
-template <size_t width, size_t height>
-class RamWriteState : public State<width, height> {
- public:
-  void handle(St7735<width, height>& sim, std::vector<uint8_t>& buffer) override { sim.ram_write(buffer); }
+// Data expected after the last command, the bytes written with DC high are dispatched on it.
+enum class State {
+  Command,  // No command yet or a command that is not implemented, its parameters are ignored.
+  Caset,
+  Raset,
+  Madctl,
+  RamWrite,
 };
 
 enum class PinLevel {
@@ -63,14 +44,19 @@ enum class PinLevel {
   High = 1,
 };
 
-union __attribute__((packed)) Pixel {
-  struct {
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-  } rgb;
-  uint8_t buffer[3];
-};
+// Pixels are kept as written to the RAM, BGR565, and only converted to RGB888 when the frame is exported.
+using Pixel = uint16_t;
+
+// Expansion of the 5 and 6 bits channels to 8 bits.
+constexpr auto make_channel_lut(size_t bits) {
+  std::array<uint8_t, 64> lut{};
+  for (size_t i = 0; i < (1u << bits); i++) {
+    lut[i] = static_cast<uint8_t>(i << (8 - bits) | ((1u << (8 - bits)) - 1));
+  }
+  return lut;
+}
+constexpr auto channel5_lut = make_channel_lut(5);
+constexpr auto channel6_lut = make_channel_lut(6);
 
 struct Cursor {
   size_t col_start, col_end, row_start, row_end, row, col;
@@ -84,44 +70,162 @@ struct Cursor {
   }
 };
 
+// Costs of the bus and the controller, used to account the time the transfers would take on the hardware.
+struct Timing {
+  uint64_t sck_hz   = 15'000'000;  // SPI clock.
+  uint64_t write_ns = 0;           // Overhead of each `spi_write`, e.g. to set up a DMA transfer.
+  uint64_t pin_ns   = 0;           // Overhead of each change of the CS or DC pins.
+  // Time the controller is busy after each command, by command.
+  std::array<uint64_t, 256> command_delay_ns = [] {
+    std::array<uint64_t, 256> delays{};
+    delays[ST7735_SWRESET] = 120'000'000;
+    delays[ST7735_SLPOUT]  = 120'000'000;
+    return delays;
+  }();
+};
+
+// Pixels written in a frame, see `St7735::end_frame`.
+struct Overdraw {
+  size_t written = 0;  // Pixel writes, counting every write of the same pixel.
+  size_t unique  = 0;  // Pixels written at least once.
+  size_t max     = 0;  // Largest number of writes of a pixel.
+};
+
+// Simulated time spent on a command, including the command byte, its parameters or pixels and the overheads.
+struct BusTime {
+  uint64_t ns   = 0;
+  size_t bytes  = 0;
+  size_t writes = 0;
+  size_t count  = 0;  // Number of times the command was sent.
+};
+
 template <size_t width, size_t height>
 class St7735 {
-  State<width, height>* state = new CommandState<width, height>();
+  State state_ = State::Command;
 
-  std::array<std::array<Pixel, width>, height> frame_buffer;
+  // Landscape rows of `width` pixels.
+  std::array<Pixel, width * height> frame_buffer;
   Cursor cursor;
 
   PinLevel dc_pin_ = PinLevel::High;
   PinLevel cs_pin_ = PinLevel::High;
   LCD_Orientation orientation_;
+  // Landscape, as set by the initialization scripts, in which the frame buffer is stored.
+  uint8_t madctl_ = ST77_MADCTL_MV | ST77_MADCTL_MX | ST77_MADCTL_RGB;
+
+  // Parse progress kept between writes: the parameters received for the last command and the first byte of a pixel.
+  std::array<uint8_t, 4> params_;
+  size_t param_count_ = 0;
+  std::optional<uint8_t> pending_byte_;
+
+  // Bus time accounting, the pin overheads are charged to the command of the next write.
+  Timing timing_;
+  std::array<BusTime, 256> bus_time_;
+  uint8_t command_         = ST7735_NOP;
+  uint64_t time_ns_        = 0;
+  uint64_t frame_start_ns_ = 0;
+  uint64_t pending_pin_ns_ = 0;
+  std::vector<uint64_t> frame_ns_;
+
+  // Number of writes of each pixel in the current frame and in the last frame closed by `end_frame`.
+  std::vector<uint16_t> writes_       = std::vector<uint16_t>(width * height);
+  std::vector<uint16_t> frame_writes_ = std::vector<uint16_t>(width * height);
+  Overdraw overdraw_;
+
+  static void count_write(uint16_t& writes) { writes += writes != UINT16_MAX; }
+
+  void account(uint8_t command, size_t bytes, uint64_t overhead_ns) {
+    uint64_t ns = bytes * 8 * 1'000'000'000 / timing_.sck_hz + overhead_ns;
+    bus_time_[command].ns += ns;
+    bus_time_[command].bytes += bytes;
+    time_ns_ += ns;
+  }
+
+  // Whether RAM rows are frame buffer rows, so consecutive pixels of a row are contiguous in the frame buffer.
+  bool landscape() const {
+    return (madctl_ & (ST77_MADCTL_MV | ST77_MADCTL_MX | ST77_MADCTL_MY)) == (ST77_MADCTL_MV | ST77_MADCTL_MX);
+  }
+
+  // Map a RAM address to the frame buffer through the MADCTL address mode, or nullptr if it is out of the panel. The
+  // panel is `height` columns by `width` rows, the frame buffer holds it rotated to landscape.
+  Pixel* pixel_at(size_t row, size_t col) {
+    size_t x = col, y = row;
+    if (madctl_ & ST77_MADCTL_MV) {
+      std::swap(x, y);
+    }
+    if (x >= height || y >= width) {
+      return nullptr;
+    }
+    if (madctl_ & ST77_MADCTL_MX) {
+      x = height - 1 - x;
+    }
+    if (madctl_ & ST77_MADCTL_MY) {
+      y = width - 1 - y;
+    }
+    return &frame_buffer[(height - 1 - x) * width + y];
+  }
 
  public:
   St7735() {}
 
-  void set_state(State<width, height>* new_state) { state = new_state; }
-  void update(std::vector<uint8_t>& data) { state->handle(*this, data); }
+  // Bytes written with DC low are commands and the bytes written with DC high are the parameters or the pixels of the
+  // last command, so a command, its parameters and the pixels may be split across any number of writes.
+  void spi_write(std::span<const uint8_t> data) {
+    uint64_t overhead_ns = timing_.write_ns + std::exchange(pending_pin_ns_, 0);
+    if (dc_pin_ == PinLevel::Low) {
+      // The write and its overhead are charged to the first command.
+      if (!data.empty()) {
+        bus_time_[data.front()].writes++;
+      }
+      for (uint8_t cmd : data) {
+        bus_time_[cmd].count++;
+        account(cmd, 1, std::exchange(overhead_ns, 0) + timing_.command_delay_ns[cmd]);
+        parse_command(cmd);
+      }
+      return;
+    }
+    bus_time_[command_].writes++;
+    account(command_, data.size(), overhead_ns);
 
-  void spi_write(uint8_t* data, size_t len) {
-    std::vector<uint8_t> vec(data, data + len);
-    update(vec);
+    switch (state_) {
+      case State::Command:
+        // Parameters of commands that are not implemented.
+        break;
+      case State::Caset:
+      case State::Raset:
+      case State::Madctl:
+        for (uint8_t byte : data) {
+          parse_parameter(byte);
+        }
+        break;
+      case State::RamWrite:
+        ram_write(data);
+        break;
+    }
   }
 
-  void parse_commands(std::vector<uint8_t>& buffer) {
+  void parse_command(uint8_t cmd) {
     LOG(std::format("{}: ", __func__));
-    uint8_t cmd = buffer[0];
+    state_        = State::Command;
+    command_      = cmd;
+    param_count_  = 0;
+    pending_byte_ = std::nullopt;
     switch (cmd) {
-      break;
       case ST7735_CASET:
         LOG(std::format("CASET: "));
-        this->set_state(new CasetState<width, height>());
+        state_ = State::Caset;
         break;
       case ST7735_RASET:
         LOG(std::format("RASET: "));
-        this->set_state(new RasetState<width, height>());
+        state_ = State::Raset;
         break;
       case ST7735_RAMWR:
         LOG(std::format("RAMWR:\n"));
-        this->set_state(new RamWriteState<width, height>());
+        state_ = State::RamWrite;
+        break;
+      case ST7735_MADCTL:
+        LOG(std::format("MADCTL: "));
+        state_ = State::Madctl;
         break;
       case ST7735_NOP:
       case ST7735_SWRESET:
@@ -137,7 +241,6 @@ class St7735 {
       case ST7735_DISPON:
       case ST7735_PTLAR:
       case ST7735_COLMOD:
-      case ST7735_MADCTL:
       case ST7735_FRMCTR1:
       case ST7735_FRMCTR2:
       case ST7735_FRMCTR3:
@@ -163,76 +266,176 @@ class St7735 {
     }
   }
 
-  void parse_caset(std::vector<uint8_t>& buffer) {
+  // Parameters are collected until the command has all of them.
+  void parse_parameter(uint8_t byte) {
+    if (param_count_ < params_.size()) {
+      params_[param_count_] = byte;
+    }
+    param_count_++;
+    if (state_ == State::Caset && param_count_ == 4) {
+      parse_caset(params_);
+    } else if (state_ == State::Raset && param_count_ == 4) {
+      parse_raset(params_);
+    } else if (state_ == State::Madctl && param_count_ == 1) {
+      parse_madctl(params_);
+    }
+  }
+
+  void parse_caset(std::span<const uint8_t, 4> buffer) {
     cursor.col = cursor.col_start = buffer[0] << 8 | buffer[1];
     cursor.col_end                = buffer[2] << 8 | buffer[3];
     LOG(std::format("x: {},y:{} \n", col_addr_s_, col_addr_e_));
   }
 
-  void parse_raset(std::vector<uint8_t>& buffer) {
+  void parse_raset(std::span<const uint8_t, 4> buffer) {
     cursor.row = cursor.row_start = buffer[0] << 8 | buffer[1];
     cursor.row_end                = buffer[2] << 8 | buffer[3];
     LOG(std::format("x: {},y:{} \n", row_addr_s_, row_addr_e_));
   }
 
-  void ram_write(std::vector<uint8_t>& buffer) {
-    for (size_t i = 0; i < buffer.size() - 1; i += 2) {
-      uint16_t bgr565 = buffer[i] << 8 | buffer[i + 1];
-      Pixel pixel    = {.rgb = {.r = static_cast<uint8_t>((((bgr565 >> 0) & 0x1f) << 3) | 0x7),
-                                .g = static_cast<uint8_t>((((bgr565 >> 5) & 0x3f) << 2) | 0x3),
-                                .b = static_cast<uint8_t>((((bgr565 >> 11) & 0x1f) << 3) | 0x7)}};
+  void parse_madctl(std::span<const uint8_t> buffer) {
+    madctl_ = buffer[0];
+    LOG(std::format("{:#02x}\n", madctl_));
+  }
 
-      frame_buffer[cursor.row][cursor.col] = pixel;
+  // A pixel split between two writes is completed with the first byte of the next one.
+  void ram_write(std::span<const uint8_t> buffer) {
+    if (pending_byte_ && !buffer.empty()) {
+      write_pixel(*pending_byte_ << 8 | buffer[0]);
+      pending_byte_ = std::nullopt;
+      buffer        = buffer.subspan(1);
+    }
+    while (buffer.size() >= 2) {
+      // Pixels up to the end of the window row are copied at once when they are contiguous in the frame buffer.
+      size_t run  = 1;
+      Pixel* dest = pixel_at(cursor.row, cursor.col);
+      if (dest && landscape() && cursor.col <= cursor.col_end) {
+        run = std::min({buffer.size() / 2, cursor.col_end + 1 - cursor.col, width - cursor.col});
+      }
+      if (dest) {
+        uint16_t* writes = &writes_[dest - frame_buffer.data()];
+        for (size_t i = 0; i < run; i++) {
+          dest[i] = static_cast<Pixel>(buffer[2 * i] << 8 | buffer[2 * i + 1]);
+          count_write(writes[i]);
+        }
+      }
+      cursor.col += run - 1;
       cursor++;
+      buffer = buffer.subspan(2 * run);
+    }
+    if (!buffer.empty()) {
+      pending_byte_ = buffer[0];
+    }
+  }
+
+  void write_pixel(Pixel bgr565) {
+    if (Pixel* dest = pixel_at(cursor.row, cursor.col)) {
+      *dest = bgr565;
+      count_write(writes_[dest - frame_buffer.data()]);
+    }
+    cursor++;
+  }
+
+  // The frame as RGB888, row by row.
+  std::vector<uint8_t> rgb888() const {
+    std::vector<uint8_t> rgb(width * height * 3);
+    auto out = rgb.begin();
+    for (Pixel pixel : frame_buffer) {
+      *out++ = channel5_lut[pixel & 0x1f];
+      *out++ = channel6_lut[(pixel >> 5) & 0x3f];
+      *out++ = channel5_lut[pixel >> 11];
     }
+    return rgb;
   }
 
   void render() {
-    for (auto& row : frame_buffer) {
+    for (size_t row = 0; row < height; row++) {
       LOG(std::format("{{"));
-      for (auto& pixel : row) {
-        std::cout << std::format("{:02x}{:02x}{:02x},", pixel.rgb.r, pixel.rgb.g, pixel.rgb.b);
+      for (Pixel pixel : std::span(frame_buffer).subspan(row * width, width)) {
+        std::cout << std::format("{:02x}{:02x}{:02x},", channel5_lut[pixel & 0x1f], channel6_lut[(pixel >> 5) & 0x3f],
+                                 channel5_lut[pixel >> 11]);
       }
       std::cout << std::format("}}\n");
     }
   }
 
   void bmp(std::string filename) {
-    unsigned char bpm[width * height * 3];
-
-    size_t i = 0;
-    for (auto& row : frame_buffer) {
-      for (auto& pixel : row) {
-        bpm[i++] = pixel.rgb.r;
-        bpm[i++] = pixel.rgb.g;
-        bpm[i++] = pixel.rgb.b;
-      }
-    }
-    stbi_write_bmp(filename.c_str(), width, height, 3, bpm);
+    std::vector<uint8_t> rgb = rgb888();
+    stbi_write_bmp(filename.c_str(), width, height, 3, rgb.data());
   }
 
   void png(std::string filename) {
-    unsigned char png[width * height * 3];
-
-    size_t i = 0;
-    for (auto& row : frame_buffer) {
-      for (auto& pixel : row) {
-        png[i++] = pixel.rgb.r;
-        png[i++] = pixel.rgb.g;
-        png[i++] = pixel.rgb.b;
-      }
-    }
-    stbi_write_png(filename.c_str(), width, height, 3, png, 3 * width);
+    std::vector<uint8_t> rgb = rgb888();
+    stbi_write_png(filename.c_str(), width, height, 3, rgb.data(), 3 * width);
   }
 
   void dc_pin(PinLevel level) {
-    if (level == PinLevel::Low) {
-      this->set_state(new CommandState<width, height>());
+    if (level != dc_pin_) {
+      pending_pin_ns_ += timing_.pin_ns;
     }
     dc_pin_ = level;
   }
 
-  void cs_pin(PinLevel level) { cs_pin_ = level; }
+  void cs_pin(PinLevel level) {
+    if (level != cs_pin_) {
+      pending_pin_ns_ += timing_.pin_ns;
+    }
+    cs_pin_ = level;
+  }
+
+  void set_timing(const Timing& timing) { timing_ = timing; }
+
+  // Simulated time since the start or the last `reset_bus_time`.
+  uint64_t bus_time_ns() const { return time_ns_; }
+  const BusTime& bus_time(uint8_t command) const { return bus_time_[command]; }
+
+  // Close a frame, returning the simulated time since the end of the previous one. The times are kept in `frame_ns`
+  // and the pixel writes of the frame in `overdraw` and `overdraw_png`.
+  uint64_t end_frame() {
+    frame_ns_.push_back(time_ns_ - frame_start_ns_);
+    frame_start_ns_ = time_ns_;
+
+    std::swap(writes_, frame_writes_);
+    std::fill(writes_.begin(), writes_.end(), 0);
+    overdraw_ = {};
+    for (uint16_t writes : frame_writes_) {
+      overdraw_.written += writes;
+      overdraw_.unique += writes != 0;
+      overdraw_.max = std::max<size_t>(overdraw_.max, writes);
+    }
+    return frame_ns_.back();
+  }
+  const std::vector<uint64_t>& frame_ns() const { return frame_ns_; }
+
+  const Overdraw& overdraw() const { return overdraw_; }
+
+  // Heatmap of the pixel writes of the last frame: black for none, then blue, green, light red and red for 4 or more.
+  void overdraw_png(std::string filename) const {
+    static constexpr std::array<std::array<uint8_t, 3>, 5> colors = {{
+        {0x00, 0x00, 0x00},
+        {0x00, 0x40, 0xff},
+        {0x00, 0xc0, 0x00},
+        {0xff, 0x80, 0x80},
+        {0xff, 0x00, 0x00},
+    }};
+    std::vector<uint8_t> rgb(width * height * 3);
+    auto out = rgb.begin();
+    for (uint16_t writes : frame_writes_) {
+      const auto& color = colors[std::min<size_t>(writes, colors.size() - 1)];
+      out               = std::copy(color.begin(), color.end(), out);
+    }
+    stbi_write_png(filename.c_str(), width, height, 3, rgb.data(), 3 * width);
+  }
+
+  void reset_bus_time() {
+    bus_time_       = {};
+    time_ns_        = 0;
+    frame_start_ns_ = 0;
+    pending_pin_ns_ = 0;
+    frame_ns_.clear();
+  }
 };
 
 }  // namespakce Simulator
+
+#endif
@@ -0,0 +1,106 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Replay of the bus traces recorded by `LCD_trace_init` (src/core/lcd_trace.h) into the simulator.
+
+#ifndef DISPLAY_DRIVERS_SIMULATOR_ST7735_REPLAY_HH_
+#define DISPLAY_DRIVERS_SIMULATOR_ST7735_REPLAY_HH_
+
+#include <src/core/lcd_trace.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "controller.hh"
+
+namespace Simulator {
+
+struct TraceRecord {
+  uint8_t event;
+  uint32_t value;
+  std::span<const uint8_t> data;  // Bytes written, empty if they were not captured.
+};
+
+// Parse a trace, the records refer to `trace` so it must outlive them. Returns std::nullopt and sets `error` if the
+// trace is malformed.
+inline std::optional<std::vector<TraceRecord>> parse_trace(std::span<const uint8_t> trace, std::string& error) {
+  auto le = [](std::span<const uint8_t> bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes.size(); i-- > 0;) {
+      value = value << 8 | bytes[i];
+    }
+    return value;
+  };
+
+  if (trace.size() < LCD_TRACE_HEADER_SIZE || std::string(trace.begin(), trace.begin() + 4) != "LCDT") {
+    error = "not a trace, the magic is missing";
+    return std::nullopt;
+  }
+  if (le(trace.subspan(4, 4)) != LCD_TRACE_VERSION) {
+    error = "unsupported trace version";
+    return std::nullopt;
+  }
+
+  std::vector<TraceRecord> records;
+  for (size_t offset = LCD_TRACE_HEADER_SIZE; offset < trace.size();) {
+    if (trace.size() - offset < LCD_TRACE_RECORD_SIZE) {
+      error = "truncated record";
+      return std::nullopt;
+    }
+    std::span<const uint8_t> record = trace.subspan(offset, LCD_TRACE_RECORD_SIZE);
+    TraceRecord parsed{.event = record[0], .value = static_cast<uint32_t>(le(record.subspan(4, 4)))};
+    offset += LCD_TRACE_RECORD_SIZE;
+    if (record[1] & LCD_TRACE_FLAG_DATA) {
+      if (trace.size() - offset < parsed.value) {
+        error = "truncated data";
+        return std::nullopt;
+      }
+      parsed.data = trace.subspan(offset, parsed.value);
+      offset += parsed.value;
+    }
+    records.push_back(parsed);
+  }
+  return records;
+}
+
+// Feed the records to the display, calling `on_frame` at each frame marker after closing the frame. Returns the number
+// of bytes written, writes whose data was not captured are skipped.
+template <typename Display>
+size_t replay_trace(Display& display, std::span<const TraceRecord> records,
+                    const std::function<void()>& on_frame = nullptr) {
+  size_t bytes = 0;
+  for (const TraceRecord& record : records) {
+    switch (record.event) {
+      case LCD_TraceSpiWrite:
+        if (record.data.size() != record.value) {
+          break;
+        }
+        display.spi_write(record.data);
+        bytes += record.data.size();
+        break;
+      case LCD_TraceGpioWrite:
+        display.cs_pin(record.value & 1 ? PinLevel::High : PinLevel::Low);
+        display.dc_pin(record.value & 2 ? PinLevel::High : PinLevel::Low);
+        break;
+      case LCD_TraceFrame:
+        display.end_frame();
+        if (on_frame) {
+          on_frame();
+        }
+        break;
+      default:
+        // Reads, resets, backlight and delays don't change the RAM.
+        break;
+    }
+  }
+  return bytes;
+}
+
+}  // namespace Simulator
+
+#endif
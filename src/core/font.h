@@ -13,17 +13,58 @@ extern "C" {
 
 #include <stdint.h>
 
+/**
+ * @brief Character descriptor.
+ *
+ * Glyph rows in the bitmap encoding are `FONT_ROW_STRIDE(width)` bytes long, so glyphs up to 32 pixels wide take up
+ * to 4 bytes per row.
+ */
 typedef struct FontCharInfo_st {
-  unsigned char width;
-  unsigned short position;
+  unsigned char width;     /*< Width of the glyph in pixels. */
+  unsigned short position; /*< Offset of the glyph in the bitmap array. */
 } FontCharInfo;
 
+/** Number of bytes of a glyph row in the bitmap encoding. */
+#define FONT_ROW_STRIDE(width) (((width) + 7) / 8)
+
+/**
+ * @brief Layout of the glyphs in the bitmap array.
+ */
+typedef enum FontEncoding_e {
+  /** One or more bytes per row, `(width + 7) / 8`, with the leftmost pixel in the least significant bit. */
+  FontEncodingBitmap = 0,
+  /** Two bytes with the number of blank rows at the top and the number of rows stored, followed by the bits of the
+   * stored rows packed without padding between rows, leftmost pixel first from the least significant bit. The rows
+   * not stored are blank. */
+  FontEncodingPacked = 1,
+  /** Anti-aliased, 2 bits of coverage per pixel from 0 (background) to 3 (foreground). Each row is
+   * `(width * 2 + 7) / 8` bytes, with the leftmost pixel in the least significant bits. */
+  FontEncodingGray2 = 2,
+  /** Anti-aliased, 4 bits of coverage per pixel from 0 (background) to 15 (foreground), laid out as `FontEncodingGray2`
+   * with `(width * 4 + 7) / 8` bytes per row. */
+  FontEncodingGray4 = 3,
+} FontEncoding;
+
+/**
+ * @brief Range of consecutive code points present in a font.
+ */
+typedef struct FontRange_st {
+  uint32_t first;       /*< First code point of the range. */
+  unsigned short count; /*< Number of code points in the range. */
+  unsigned short index; /*< Index in the descriptor array of the first code point. */
+} FontRange;
+
 typedef struct Font_st {
   unsigned char height;                 /*<  */
   unsigned char startCharacter;         /*< first char of the  ASCII table found in the bitmap array. */
   unsigned char endCharacter;           /*< last char of the ASCII table found in the bitmap array. */
   const FontCharInfo *descriptor_table; /*< Character descriptor array. */
   const unsigned char *bitmap_table;    /*< Character bitmap array. */
+  unsigned char fixed_width;            /*< Width of every character of monospace fonts, 0 for proportional fonts. */
+  const FontRange *ranges;              /*< Code point ranges sorted by code point, used instead of
+                                            startCharacter..endCharacter when not NULL. */
+  unsigned short range_count;           /*< Number of entries in the ranges array. */
+  unsigned char encoding;               /*< Layout of the bitmap array, see #FontEncoding. */
 } Font;
 
 #ifdef __cplusplus
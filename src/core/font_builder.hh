@@ -0,0 +1,230 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Compile time font builder, for icons and small custom fonts without running fontgen.
+//
+// Glyphs are written as ASCII art, one string per row with '#' for the foreground and ' ' or '.' for the background.
+// The tables are computed by the compiler and placed in read-only data like the generated fonts:
+//
+//   static constexpr auto arrows_data = FontBuilder::compile([] {
+//     return std::array{
+//         FontBuilder::Glyph<5>{U'←', {"  #  ",
+//                                      " #   ",
+//                                      "#####",
+//                                      " #   ",
+//                                      "  #  "}},
+//         FontBuilder::Glyph<5>{U'→', {"  #  ",
+//                                      "   # ",
+//                                      "#####",
+//                                      "   # ",
+//                                      "  #  "}},
+//     };
+//   });
+//   constexpr Font arrows = arrows_data.font();
+//
+// Malformed glyphs are rejected with a compile error pointing to the failed check.
+
+#ifndef DISPLAY_DRIVERS_COMMON_FONT_BUILDER_HH_
+#define DISPLAY_DRIVERS_COMMON_FONT_BUILDER_HH_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "font.h"
+
+namespace FontBuilder {
+
+template <size_t Height>
+struct Glyph {
+  char32_t codepoint;
+  std::array<std::string_view, Height> rows;
+
+  constexpr size_t width() const { return rows[0].size(); }
+  constexpr bool pixel(size_t row, size_t column) const { return rows[row][column] == '#'; }
+
+  constexpr bool blank(size_t row) const { return rows[row].find('#') == std::string_view::npos; }
+
+  // First and last plus one rows that are not blank.
+  constexpr size_t top() const {
+    size_t row = 0;
+    while (row < Height && blank(row)) row++;
+    return row;
+  }
+  constexpr size_t bottom() const {
+    size_t row = Height;
+    while (row > top() && blank(row - 1)) row--;
+    return row;
+  }
+
+  constexpr size_t bitmap_size() const { return Height * FONT_ROW_STRIDE(width()); }
+  constexpr size_t packed_size() const { return 2 + ((bottom() - top()) * width() + 7) / 8; }
+};
+
+/**
+ * @brief Tables of a compiled font, see `compile`.
+ */
+template <size_t Count, size_t Size, size_t Ranges>
+struct FontData {
+  unsigned char height;
+  unsigned char start_character;
+  unsigned char end_character;
+  unsigned char fixed_width;
+  FontEncoding encoding;
+  std::array<FontCharInfo, Count> descriptors;
+  std::array<unsigned char, Size> bitmaps;
+  std::array<FontRange, Ranges> ranges;
+
+  // The font refers to the tables, so it is a constant only when the object has static storage duration.
+  constexpr Font font() const {
+    return Font{
+        .height           = height,
+        .startCharacter   = start_character,
+        .endCharacter     = end_character,
+        .descriptor_table = descriptors.data(),
+        .bitmap_table     = bitmaps.data(),
+        .fixed_width      = fixed_width,
+        .ranges           = Ranges ? ranges.data() : nullptr,
+        .range_count      = static_cast<unsigned short>(Ranges),
+        .encoding         = static_cast<unsigned char>(encoding),
+    };
+  }
+};
+
+namespace internal {
+
+// Failed checks throw, which is not allowed in a constant expression, so the compiler reports the message.
+template <size_t Height, size_t Count>
+consteval std::array<Glyph<Height>, Count> validate(std::array<Glyph<Height>, Count> glyphs) {
+  static_assert(Height > 0 && Height <= UINT8_MAX, "FontBuilder: the height must be between 1 and 255 rows");
+  static_assert(Count > 0, "FontBuilder: the font needs at least one glyph");
+
+  size_t size = 0;
+  for (const auto &glyph : glyphs) {
+    if (glyph.width() == 0 || glyph.width() > 32) {
+      throw "FontBuilder: glyphs must be from 1 to 32 pixels wide";
+    }
+    for (const auto &row : glyph.rows) {
+      if (row.size() != glyph.width()) {
+        throw "FontBuilder: every row of a glyph must have the same width, or a row is missing";
+      }
+      if (row.find_first_not_of(" .#") != std::string_view::npos) {
+        throw "FontBuilder: glyph rows may only contain '#', ' ' and '.'";
+      }
+    }
+    if (glyph.codepoint > 0x10FFFF) {
+      throw "FontBuilder: invalid code point";
+    }
+    size += std::min(glyph.bitmap_size(), glyph.packed_size());
+  }
+  if (size > UINT16_MAX) {
+    throw "FontBuilder: the glyphs don't fit in 64KB";
+  }
+
+  std::sort(glyphs.begin(), glyphs.end(), [](const auto &a, const auto &b) { return a.codepoint < b.codepoint; });
+  for (size_t i = 1; i < Count; i++) {
+    if (glyphs[i].codepoint == glyphs[i - 1].codepoint) {
+      throw "FontBuilder: duplicated code point";
+    }
+  }
+  return glyphs;
+}
+
+template <size_t Height, size_t Count>
+consteval bool use_packed(const std::array<Glyph<Height>, Count> &glyphs) {
+  size_t bitmap = 0, packed = 0;
+  for (const auto &glyph : glyphs) {
+    bitmap += glyph.bitmap_size();
+    packed += glyph.packed_size();
+  }
+  return packed < bitmap;
+}
+
+template <size_t Height, size_t Count>
+consteval size_t bitmaps_size(const std::array<Glyph<Height>, Count> &glyphs) {
+  size_t size = 0;
+  for (const auto &glyph : glyphs) {
+    size += use_packed(glyphs) ? glyph.packed_size() : glyph.bitmap_size();
+  }
+  return size;
+}
+
+// Number of code point ranges, 0 when the glyphs are a single range within the first 256 code points.
+template <size_t Height, size_t Count>
+consteval size_t range_count(const std::array<Glyph<Height>, Count> &glyphs) {
+  size_t ranges = 1;
+  for (size_t i = 1; i < Count; i++) {
+    ranges += glyphs[i].codepoint != glyphs[i - 1].codepoint + 1;
+  }
+  return ranges == 1 && glyphs[Count - 1].codepoint <= UINT8_MAX ? 0 : ranges;
+}
+
+}  // namespace internal
+
+/**
+ * @brief Build the tables of a font at compile time.
+ *
+ * The glyphs may be given in any order, they are sorted by code point and indexed by code point ranges when they are
+ * not a single range of Latin-1 characters. The encoding is the smallest of `FontEncodingBitmap` and
+ * `FontEncodingPacked`.
+ *
+ * @param Glyphs Lambda without captures returning a `std::array` of `Glyph`, all with the same height.
+ * @return The tables, see `FontData::font`.
+ */
+template <typename Glyphs>
+consteval auto compile(Glyphs) {
+  constexpr auto glyphs   = internal::validate(Glyphs{}());
+  constexpr size_t count  = glyphs.size();
+  constexpr size_t height = glyphs[0].rows.size();
+  constexpr bool packed   = internal::use_packed(glyphs);
+  constexpr size_t ranges = internal::range_count(glyphs);
+
+  FontData<count, internal::bitmaps_size(glyphs), ranges> data{};
+  data.height          = static_cast<unsigned char>(height);
+  data.start_character = static_cast<unsigned char>(ranges ? 0 : glyphs[0].codepoint);
+  data.end_character   = static_cast<unsigned char>(ranges ? 0 : glyphs[count - 1].codepoint);
+  data.fixed_width     = static_cast<unsigned char>(glyphs[0].width());
+  data.encoding        = packed ? FontEncodingPacked : FontEncodingBitmap;
+
+  size_t position = 0, range = 0;
+  for (size_t i = 0; i < count; i++) {
+    const auto &glyph = glyphs[i];
+    if (glyph.width() != data.fixed_width) {
+      data.fixed_width = 0;
+    }
+    if (ranges && (i == 0 || glyph.codepoint != glyphs[i - 1].codepoint + 1)) {
+      data.ranges[range++] = FontRange{.first = glyph.codepoint, .count = 0, .index = static_cast<unsigned short>(i)};
+    }
+    if (ranges) {
+      data.ranges[range - 1].count++;
+    }
+    data.descriptors[i] = FontCharInfo{.width    = static_cast<unsigned char>(glyph.width()),
+                                       .position = static_cast<unsigned short>(position)};
+
+    if (packed) {
+      data.bitmaps[position++] = static_cast<unsigned char>(glyph.top());
+      data.bitmaps[position++] = static_cast<unsigned char>(glyph.bottom() - glyph.top());
+      size_t bit = 0;
+      for (size_t row = glyph.top(); row < glyph.bottom(); row++) {
+        for (size_t column = 0; column < glyph.width(); column++, bit++) {
+          data.bitmaps[position + bit / 8] |= static_cast<unsigned char>(glyph.pixel(row, column) << (bit % 8));
+        }
+      }
+      position += (bit + 7) / 8;
+    } else {
+      for (size_t row = 0; row < height; row++, position += FONT_ROW_STRIDE(glyph.width())) {
+        for (size_t column = 0; column < glyph.width(); column++) {
+          data.bitmaps[position + column / 8] |= static_cast<unsigned char>(glyph.pixel(row, column) << (column % 8));
+        }
+      }
+    }
+  }
+  return data;
+}
+
+}  // namespace FontBuilder
+
+#endif
@@ -13,5 +13,6 @@ Result LCD_Init(LCD_Context *ctx, LCD_Interface *interface, uint32_t width, uint
   ctx->height      = height;
   ctx->width       = width;
   ctx->orientation = orientation;
+  ctx->text_mode   = LCD_TextOpaque;
   return (Result){.code = 0};
 }
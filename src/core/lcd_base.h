@@ -52,6 +52,17 @@ typedef enum {
   LCD_Rotate270,
 } LCD_Orientation;
 
+typedef enum {
+  LCD_TextOpaque = 0,  /*!< Paint the whole character cell, using the background color where the glyph is clear. */
+  LCD_TextTransparent, /*!< Paint only the pixels set in the glyph, leaving the background untouched. */
+  LCD_TextAuto,        /*!< Transparent, or opaque when it is cheaper for fragmented glyphs, over a plain background. */
+} LCD_TextMode;
+
+typedef enum {
+  LCD_TextUp = 0, /*!< Rotated 90 degrees counterclockwise, read from bottom to top. */
+  LCD_TextDown,   /*!< Rotated 90 degrees clockwise, read from top to bottom. */
+} LCD_TextDirection;
+
 typedef enum ErrorCode_e {
   ErrorOk              = 0,
   ErrorNullArgs        = -1,
@@ -119,6 +130,22 @@ typedef struct LCD_Interface_st {
    * @param millis Time the delay should take in milliseconds.
    */
   void (*timer_delay)(void *handle, uint32_t millis);
+
+  /**
+   * @brief Called when a driver function starts, to measure how long it takes, e.g. with a cycle counter.
+   *
+   * Both profiling callbacks are optional and can be NULL. The calls nest when a driver function calls another one.
+   *
+   * @param op Identifier of the function, defined by the driver, e.g. `St7735Op`.
+   */
+  void (*profile_begin)(void *handle, uint32_t op);
+
+  /**
+   * @brief Called when the driver function started with `profile_begin` returns.
+   *
+   * @param op Identifier of the function, the same given to `profile_begin`.
+   */
+  void (*profile_end)(void *handle, uint32_t op);
 } LCD_Interface;
 
 typedef struct LCD_Context_st {
@@ -128,6 +155,7 @@ typedef struct LCD_Context_st {
   const Font *font;          /*!< Font bitmaps*/
   uint32_t background_color; /*< Background color for font bitmaps */
   uint32_t foreground_color; /*< Foreground color for font bitmaps */
+  LCD_TextMode text_mode;    /*< How the background of the characters is painted */
   LCD_Orientation orientation;
 } LCD_Context;
 
@@ -147,6 +175,33 @@ typedef struct LCD_rectangle_st {
   size_t height;    /*!< Height from the origin.*/
 } LCD_rectangle;
 
+typedef enum {
+  LCD_PixelFormatRgb565 = 0, /*!< 2 bytes per pixel in RGB565 format. */
+  LCD_PixelFormatBgr888,     /*!< 3 bytes per pixel, as accepted by the `draw_bgr` functions. */
+  LCD_PixelFormatNative,     /*!< 2 bytes per pixel already in the controller format, see `LCD_rgb24_to_bgr565`. */
+} LCD_PixelFormat;
+
+/**
+ * @brief Describe an image in memory, which may be a region of a larger buffer such as a sprite sheet.
+ */
+typedef struct LCD_Image_st {
+  const uint8_t *data;    /*!< Pointer to the first pixel of the image.*/
+  LCD_PixelFormat format; /*!< Format of the pixels.*/
+  size_t width;           /*!< Width of the image in pixels.*/
+  size_t height;          /*!< Height of the image in pixels.*/
+  size_t stride;          /*!< Bytes between the start of two consecutive rows, 0 if the rows are contiguous.*/
+} LCD_Image;
+
+/**
+ * @brief Callback used to generate the pixels of a single row of a region.
+ *
+ * @param user Pointer passed unchanged from the caller.
+ * @param row Index of the row to be generated, relative to the origin of the region.
+ * @param[out] line Buffer to receive `width` pixels in BGR565 format, as returned by `LCD_rgb24_to_bgr565`.
+ * @param width Number of pixels in the row.
+ */
+typedef void (*LCD_LineCallback)(void *user, size_t row, uint16_t *line, size_t width);
+
 Result LCD_Init(LCD_Context *ctx, LCD_Interface *interface, uint32_t width, uint32_t height,
                 LCD_Orientation orientation);
 
@@ -162,6 +217,11 @@ static inline Result LCD_set_font_colors(LCD_Context *ctx, uint32_t background_c
   return (Result){.code = 0};
 }
 
+static inline Result LCD_set_text_mode(LCD_Context *ctx, LCD_TextMode mode) {
+  ctx->text_mode = mode;
+  return (Result){.code = 0};
+}
+
 static inline Result LCD_set_font(LCD_Context *ctx, const Font *font) {
   ctx->font = font;
   LCD_set_font_colors(ctx, 0xffffff, 0x00);
@@ -178,6 +238,12 @@ static inline Result LCD_get_font_size(LCD_Context *ctx, size_t *width, size_t *
   return (Result){.code = 0};
 }
 
+static inline size_t LCD_pixel_size(LCD_PixelFormat format) { return format == LCD_PixelFormatBgr888 ? 3 : 2; }
+
+static inline size_t LCD_image_stride(const LCD_Image *image) {
+  return image->stride ? image->stride : image->width * LCD_pixel_size(image->format);
+}
+
 static inline uint16_t LCD_rgb24_to_bgr565(uint32_t rgb) {
   uint8_t r = (rgb >> 16) & 0xFF, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
   uint16_t color = (uint16_t)(((b & 0xF8) << 8) | ((g & 0xFC) << 3) | (r >> 3));
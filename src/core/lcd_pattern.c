@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lcd_pattern.h"
+
+// 4x4 Bayer threshold matrix.
+static const uint8_t bayer4x4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+static uint32_t isqrt(uint32_t value) {
+  uint32_t result = 0, bit = 1u << 30;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+static inline uint8_t saturate(int32_t value) { return (uint8_t)(value > 0xFF ? 0xFF : value < 0 ? 0 : value); }
+
+// Convert the 8.16 fixed point channels to a BGR565 pixel. The dither threshold is scaled to the number of bits lost
+// by each channel: 3 for red and blue and 2 for green.
+static inline uint16_t to_bgr565(const int32_t channel[3], uint8_t threshold) {
+  uint8_t r = saturate((channel[0] >> 16) + (threshold >> 1));
+  uint8_t g = saturate((channel[1] >> 16) + (threshold >> 2));
+  uint8_t b = saturate((channel[2] >> 16) + (threshold >> 1));
+  return LCD_rgb24_to_bgr565((uint32_t)(r << 16 | g << 8 | b));
+}
+
+void LCD_gradient_init(LCD_Gradient *gradient, LCD_GradientType type, uint32_t from, uint32_t to, size_t width,
+                       size_t height, bool dither) {
+  size_t span = 0;
+  switch (type) {
+    case LCD_GradientHorizontal:
+      span = width - 1;
+      break;
+    case LCD_GradientVertical:
+      span = height - 1;
+      break;
+    case LCD_GradientDiagonal:
+      span = width + height - 2;
+      break;
+    case LCD_GradientRadial:
+      span = isqrt((uint32_t)((width / 2) * (width / 2) + (height / 2) * (height / 2)));
+      break;
+    default:
+      break;
+  }
+  if (width == 0 || height == 0) {
+    // An empty area has no distance to spread the colors over.
+    span = 0;
+  }
+
+  gradient->type   = type;
+  gradient->dither = dither;
+  gradient->width  = width;
+  gradient->height = height;
+  for (int i = 0; i < 3; i++) {
+    int32_t shift     = 16 - 8 * i;
+    int32_t start     = (int32_t)((from >> shift) & 0xFF);
+    int32_t end       = (int32_t)((to >> shift) & 0xFF);
+    gradient->from[i] = start * 65536;
+    gradient->step[i] = span ? (end - start) * 65536 / (int32_t)span : 0;
+  }
+}
+
+void LCD_gradient_line(void *user, size_t row, uint16_t *line, size_t width) {
+  LCD_Gradient *gradient = (LCD_Gradient *)user;
+  const uint8_t *bayer   = bayer4x4[row & 0x03];
+  int32_t channel[3]     = {gradient->from[0], gradient->from[1], gradient->from[2]};
+  int32_t step[3]        = {gradient->step[0], gradient->step[1], gradient->step[2]};
+  uint8_t threshold_mask = gradient->dither ? 0x0F : 0x00;
+
+  switch (gradient->type) {
+    case LCD_GradientVertical:
+      // Constant along the row.
+      step[0] = step[1] = step[2] = 0;
+      // fall through
+    case LCD_GradientDiagonal:
+      for (int i = 0; i < 3; i++) {
+        channel[i] += gradient->step[i] * (int32_t)row;
+      }
+      // fall through
+    case LCD_GradientHorizontal:
+      for (size_t x = 0; x < width; x++) {
+        line[x] = to_bgr565(channel, bayer[x & 0x03] & threshold_mask);
+        channel[0] += step[0];
+        channel[1] += step[1];
+        channel[2] += step[2];
+      }
+      break;
+    case LCD_GradientRadial: {
+      // The squared distance to the center is updated incrementally: (dx + 1)^2 = dx^2 + 2dx + 1.
+      int32_t dx       = -(int32_t)(gradient->width / 2);
+      int32_t dy       = (int32_t)row - (int32_t)(gradient->height / 2);
+      uint32_t squared = (uint32_t)(dx * dx + dy * dy);
+      for (size_t x = 0; x < width; x++) {
+        int32_t distance = (int32_t)isqrt(squared);
+        int32_t pixel[3] = {channel[0] + step[0] * distance, channel[1] + step[1] * distance,
+                            channel[2] + step[2] * distance};
+        line[x]          = to_bgr565(pixel, bayer[x & 0x03] & threshold_mask);
+        squared += (uint32_t)(2 * dx + 1);
+        dx++;
+      }
+    } break;
+    default:
+      break;
+  }
+}
+
+void LCD_pattern_init(LCD_Pattern *pattern, LCD_PatternType type, size_t size, uint32_t color_a, uint32_t color_b) {
+  pattern->type      = type;
+  pattern->size      = size ? size : 1;
+  pattern->colors[0] = LCD_rgb24_to_bgr565(color_a);
+  pattern->colors[1] = LCD_rgb24_to_bgr565(color_b);
+}
+
+void LCD_pattern_line(void *user, size_t row, uint16_t *line, size_t width) {
+  LCD_Pattern *pattern = (LCD_Pattern *)user;
+  size_t parity        = (row / pattern->size) & 0x01;
+
+  if (pattern->type == LCD_PatternHorizontalStripes) {
+    for (size_t x = 0; x < width; x++) {
+      line[x] = pattern->colors[parity];
+    }
+    return;
+  }
+
+  if (pattern->type == LCD_PatternVerticalStripes) {
+    parity = 0;
+  }
+  // Fill one run of `size` pixels at a time and swap the color between runs.
+  for (size_t x = 0; x < width; parity ^= 0x01) {
+    uint16_t color = pattern->colors[parity];
+    size_t end     = MIN(x + pattern->size, width);
+    while (x < end) {
+      line[x++] = color;
+    }
+  }
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DISPLAY_DRIVERS_COMMON_PATTERN_H_
+#define DISPLAY_DRIVERS_COMMON_PATTERN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lcd_base.h"
+
+typedef enum {
+  LCD_GradientHorizontal = 0, /*!< From the left to the right edge. */
+  LCD_GradientVertical,       /*!< From the top to the bottom edge. */
+  LCD_GradientDiagonal,       /*!< From the top left to the bottom right corner. */
+  LCD_GradientRadial,         /*!< From the center to the corners. */
+} LCD_GradientType;
+
+typedef enum {
+  LCD_PatternChecker = 0,       /*!< Squares of `size` pixels with alternating colors. */
+  LCD_PatternHorizontalStripes, /*!< Rows of `size` pixels with alternating colors. */
+  LCD_PatternVerticalStripes,   /*!< Columns of `size` pixels with alternating colors. */
+} LCD_PatternType;
+
+/**
+ * @brief State of a gradient generator, see `LCD_gradient_init`.
+ */
+typedef struct LCD_Gradient_st {
+  LCD_GradientType type;
+  bool dither;     /*!< Apply a 4x4 ordered dither before truncating to 565.*/
+  size_t width;    /*!< Width of the filled area in pixels.*/
+  size_t height;   /*!< Height of the filled area in pixels.*/
+  int32_t from[3]; /*!< Red, green and blue of the start color in 8.16 fixed point.*/
+  int32_t step[3]; /*!< Increment of each channel per pixel of distance in 8.16 fixed point.*/
+} LCD_Gradient;
+
+/**
+ * @brief State of a two colors pattern generator, see `LCD_pattern_init`.
+ */
+typedef struct LCD_Pattern_st {
+  LCD_PatternType type;
+  size_t size;        /*!< Size of a cell or stripe in pixels.*/
+  uint16_t colors[2]; /*!< Colors in BGR565 format.*/
+} LCD_Pattern;
+
+/**
+ * @brief Initialize a gradient generator.
+ *
+ * @param gradient The generator state.
+ * @param type The gradient direction.
+ * @param from Start color in RGB 24 bits format.
+ * @param to End color in RGB 24 bits format.
+ * @param width Width of the area to be filled, if 0 the gradient is the start color.
+ * @param height Height of the area to be filled, if 0 the gradient is the start color.
+ * @param dither If true an ordered dither is applied to hide the 565 banding.
+ */
+void LCD_gradient_init(LCD_Gradient *gradient, LCD_GradientType type, uint32_t from, uint32_t to, size_t width,
+                       size_t height, bool dither);
+
+/**
+ * @brief Generate a row of a gradient, this function is a `LCD_LineCallback` that expects a `LCD_Gradient`.
+ */
+void LCD_gradient_line(void *gradient, size_t row, uint16_t *line, size_t width);
+
+/**
+ * @brief Initialize a pattern generator.
+ *
+ * @param pattern The generator state.
+ * @param type The pattern type.
+ * @param size Size of the cells or stripes in pixels.
+ * @param color_a First color in RGB 24 bits format, used in the top left corner.
+ * @param color_b Second color in RGB 24 bits format.
+ */
+void LCD_pattern_init(LCD_Pattern *pattern, LCD_PatternType type, size_t size, uint32_t color_a, uint32_t color_b);
+
+/**
+ * @brief Generate a row of a pattern, this function is a `LCD_LineCallback` that expects a `LCD_Pattern`.
+ */
+void LCD_pattern_line(void *pattern, size_t row, uint16_t *line, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,194 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lcd_text.h"
+
+#include <stdbool.h>
+
+uint32_t LCD_utf8_next(const char **text) {
+  // Smallest code point for each sequence length, smaller values are overlong encodings.
+  static const uint32_t min_codepoint[] = {0, 0, 0x80, 0x800, 0x10000};
+  const uint8_t *bytes                  = (const uint8_t *)*text;
+  uint32_t codepoint;
+  size_t length;
+
+  if (bytes[0] == 0x00) {
+    return 0;
+  } else if (bytes[0] < 0x80) {
+    *text += 1;
+    return bytes[0];
+  } else if ((bytes[0] & 0xE0) == 0xC0) {
+    codepoint = bytes[0] & 0x1F;
+    length    = 2;
+  } else if ((bytes[0] & 0xF0) == 0xE0) {
+    codepoint = bytes[0] & 0x0F;
+    length    = 3;
+  } else if ((bytes[0] & 0xF8) == 0xF0) {
+    codepoint = bytes[0] & 0x07;
+    length    = 4;
+  } else {
+    *text += 1;
+    return LCD_REPLACEMENT_CHARACTER;
+  }
+
+  for (size_t i = 1; i < length; i++) {
+    if ((bytes[i] & 0xC0) != 0x80) {
+      *text += i;
+      return LCD_REPLACEMENT_CHARACTER;
+    }
+    codepoint = codepoint << 6 | (bytes[i] & 0x3F);
+  }
+
+  *text += length;
+  if (codepoint < min_codepoint[length] || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+    return LCD_REPLACEMENT_CHARACTER;
+  }
+  return codepoint;
+}
+
+const FontCharInfo *LCD_font_glyph(const Font *font, uint32_t codepoint) {
+  if (font->ranges == NULL) {
+    if (codepoint < font->startCharacter || codepoint > font->endCharacter) {
+      return NULL;
+    }
+    return &font->descriptor_table[codepoint - font->startCharacter];
+  }
+
+  size_t low = 0, high = font->range_count;
+  while (low < high) {
+    size_t middle          = low + (high - low) / 2;
+    const FontRange *range = &font->ranges[middle];
+    if (codepoint < range->first) {
+      high = middle;
+    } else if (codepoint >= range->first + range->count) {
+      low = middle + 1;
+    } else {
+      return &font->descriptor_table[range->index + (codepoint - range->first)];
+    }
+  }
+  return NULL;
+}
+
+const uint8_t *LCD_font_glyph_row(const Font *font, const FontCharInfo *info, size_t row, uint8_t *scratch) {
+  const uint8_t *bitmap = &font->bitmap_table[info->position];
+  size_t stride         = FONT_ROW_STRIDE(info->width);
+  if (font->encoding == FontEncodingGray2 || font->encoding == FontEncodingGray4) {
+    size_t bpp = LCD_font_bpp(font), mask = (1u << bpp) - 1;
+
+    bitmap += row * FONT_ROW_STRIDE(info->width * bpp);
+    for (size_t i = 0; i < stride; i++) {
+      scratch[i] = 0;
+    }
+    for (size_t column = 0, bit = 0; column < info->width; column++, bit += bpp) {
+      size_t level = (bitmap[bit / 8] >> (bit % 8)) & mask;
+      scratch[column / 8] |= (uint8_t)((level > mask / 2) << (column % 8));
+    }
+    return scratch;
+  }
+  if (font->encoding != FontEncodingPacked) {
+    return bitmap + row * stride;
+  }
+
+  size_t top = bitmap[0], rows = bitmap[1];
+  if (row < top || row >= top + rows) {
+    return NULL;
+  }
+  size_t bit         = (row - top) * info->width;
+  size_t shift       = bit % 8;
+  const uint8_t *src = bitmap + 2 + bit / 8;
+  // Bytes spanned by the row, so the last byte of the glyph is never read past.
+  size_t span = (shift + info->width + 7) / 8;
+  for (size_t i = 0; i < stride; i++) {
+    uint32_t bits = src[i];
+    if (i + 1 < span) {
+      bits |= (uint32_t)src[i + 1] << 8;
+    }
+    scratch[i] = (uint8_t)(bits >> shift);
+  }
+  // Clear the bits of the next row sharing the last byte.
+  if (info->width % 8) {
+    scratch[stride - 1] &= (uint8_t)((1u << (info->width % 8)) - 1);
+  }
+  return scratch;
+}
+
+bool LCD_font_glyph_coverage(const Font *font, const FontCharInfo *info, size_t row, uint8_t *coverage) {
+  size_t bpp = LCD_font_bpp(font);
+  if (bpp == 1) {
+    uint8_t scratch[LCD_GLYPH_ROW_MAX_BYTES];
+    const uint8_t *bits = LCD_font_glyph_row(font, info, row, scratch);
+    if (bits == NULL) {
+      return false;
+    }
+    for (size_t column = 0; column < info->width; column++) {
+      coverage[column] = (uint8_t)(((bits[column / 8] >> (column % 8)) & 0x01) * LCD_COVERAGE_MAX);
+    }
+    return true;
+  }
+
+  size_t mask           = (1u << bpp) - 1, step = LCD_COVERAGE_MAX / mask;
+  const uint8_t *levels = &font->bitmap_table[info->position + row * FONT_ROW_STRIDE(info->width * bpp)];
+  for (size_t column = 0, bit = 0; column < info->width; column++, bit += bpp) {
+    coverage[column] = (uint8_t)(((levels[bit / 8] >> (bit % 8)) & mask) * step);
+  }
+  return true;
+}
+
+size_t LCD_measure_text(const Font *font, const char *text, size_t length) {
+  const char *end = text;
+  size_t width    = 0;
+  if (font->fixed_width) {
+    // Count the glyphs, the code points the font lacks are not drawn.
+    while ((size_t)(end - text) < length && *end) {
+      width += (size_t)(LCD_font_glyph(font, LCD_utf8_next(&end)) != NULL);
+    }
+    return width * font->fixed_width;
+  }
+
+  while ((size_t)(end - text) < length && *end) {
+    width += LCD_font_glyph_width(font, LCD_utf8_next(&end));
+  }
+  return width;
+}
+
+const char *LCD_text_wrap(const Font *font, const char *text, size_t max_width, LCD_TextLine *line) {
+  if (text == NULL || *text == '\0') {
+    return NULL;
+  }
+
+  const char *end = text;
+  size_t width    = 0;
+  // End and width of the line up to the last space seen.
+  const char *break_end = NULL;
+  size_t break_width    = 0;
+
+  while (*end != '\0' && *end != '\n') {
+    const char *next   = end;
+    uint32_t codepoint = LCD_utf8_next(&next);
+    size_t char_width  = LCD_font_glyph_width(font, codepoint);
+    if (codepoint == ' ') {
+      break_end   = end;
+      break_width = width;
+    }
+    if (width + char_width > max_width && end != text) {
+      if (codepoint != ' ' && break_end != NULL) {
+        end   = break_end;
+        width = break_width;
+      }
+      break;
+    }
+    width += char_width;
+    end = next;
+  }
+
+  line->text   = text;
+  line->length = (size_t)(end - text);
+  line->width  = width;
+
+  // Skip the character where the line was broken.
+  if (*end == '\n' || *end == ' ') {
+    end++;
+  }
+  return end;
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DISPLAY_DRIVERS_COMMON_TEXT_H_
+#define DISPLAY_DRIVERS_COMMON_TEXT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "font.h"
+
+typedef enum {
+  LCD_AlignLeft = 0,
+  LCD_AlignCenter,
+  LCD_AlignRight,
+} LCD_TextAlign;
+
+/**
+ * @brief A line of text produced by `LCD_text_wrap`.
+ */
+typedef struct LCD_TextLine_st {
+  const char *text; /*!< Pointer to the first character of the line.*/
+  size_t length;    /*!< Number of bytes in the line.*/
+  size_t width;     /*!< Width of the line in pixels.*/
+} LCD_TextLine;
+
+#define LCD_REPLACEMENT_CHARACTER 0xFFFD
+
+/**
+ * @brief Decode the next code point of an UTF-8 string.
+ *
+ * Invalid or truncated sequences are decoded as `LCD_REPLACEMENT_CHARACTER`, consuming the bytes up to the first
+ * invalid one.
+ *
+ * @param[in,out] text Pointer to the string, advanced past the decoded sequence.
+ * @return The code point or 0 at the end of the string, in which case `text` is not advanced.
+ */
+uint32_t LCD_utf8_next(const char **text);
+
+/**
+ * @brief Get the descriptor of a character.
+ *
+ * Fonts with code point ranges are searched with a binary search, so the cost grows with the logarithm of the number
+ * of ranges.
+ *
+ * @param font The font.
+ * @param codepoint The Unicode code point of the character.
+ * @return Pointer to the descriptor or NULL if the font doesn't have the character.
+ */
+const FontCharInfo *LCD_font_glyph(const Font *font, uint32_t codepoint);
+
+/**
+ * @brief Get the width of a character in pixels, 0 if the font doesn't have the character.
+ */
+static inline size_t LCD_font_glyph_width(const Font *font, uint32_t codepoint) {
+  const FontCharInfo *info = LCD_font_glyph(font, codepoint);
+  return info ? info->width : 0;
+}
+
+/** Size of the scratch buffer needed by `LCD_font_glyph_row`, enough for the widest glyph a descriptor can hold. */
+#define LCD_GLYPH_ROW_MAX_BYTES 32
+
+/**
+ * @brief Get the bits of a glyph row, independently of the font encoding.
+ *
+ * Rows of bitmap fonts are returned in place, rows of packed fonts are unpacked into `scratch`. Blank rows trimmed by
+ * the packed encoding are reported as NULL, so they can be drawn as a background fill without looking at the bits.
+ * Anti-aliased fonts are reduced to the pixels with at least half coverage.
+ *
+ * @param font The font.
+ * @param info The descriptor of the glyph.
+ * @param row The row, from 0 to `font->height - 1`.
+ * @param scratch Buffer of at least `LCD_GLYPH_ROW_MAX_BYTES` bytes.
+ * @return The bits of the row with the leftmost pixel in the least significant bit of the first byte, or NULL if the
+ * row is blank.
+ */
+const uint8_t *LCD_font_glyph_row(const Font *font, const FontCharInfo *info, size_t row, uint8_t *scratch);
+
+/** Coverage of a pixel fully in the foreground color, see `LCD_font_glyph_coverage`. */
+#define LCD_COVERAGE_MAX 15
+
+/**
+ * @brief Get the number of bits per pixel of a font, 1 for the monochrome encodings.
+ */
+static inline size_t LCD_font_bpp(const Font *font) {
+  return font->encoding == FontEncodingGray4 ? 4 : font->encoding == FontEncodingGray2 ? 2 : 1;
+}
+
+/**
+ * @brief Get the coverage of each pixel of a glyph row, independently of the font encoding.
+ *
+ * The coverage goes from 0 (background) to `LCD_COVERAGE_MAX` (foreground), monochrome fonts only use both ends and
+ * 2bpp fonts use every fifth value.
+ *
+ * @param font The font.
+ * @param info The descriptor of the glyph.
+ * @param row The row, from 0 to `font->height - 1`.
+ * @param[out] coverage Receives `info->width` values.
+ * @return False if the row is blank, in which case `coverage` is not written.
+ */
+bool LCD_font_glyph_coverage(const Font *font, const FontCharInfo *info, size_t row, uint8_t *coverage);
+
+/**
+ * @brief Measure the width of a text in pixels without drawing it.
+ *
+ * For monospace fonts the width is computed without looking up each character.
+ *
+ * @param font The font.
+ * @param text Pointer to an UTF-8 text.
+ * @param length Number of bytes to be measured, the measure stops earlier at a null character.
+ * @return The width in pixels.
+ */
+size_t LCD_measure_text(const Font *font, const char *text, size_t length);
+
+/**
+ * @brief Get the next line of a text wrapped to a maximum width.
+ *
+ * Lines are broken at new line characters and at the last space that fits, the spaces where a line is broken are not
+ * part of any line. Words wider than `max_width` are broken at the last character that fits.
+ *
+ * @param font The font.
+ * @param text Pointer to a null terminated UTF-8 string.
+ * @param max_width Maximum width of the line in pixels.
+ * @param[out] line Receives the line.
+ * @return Pointer to the start of the next line or NULL if there are no more lines.
+ */
+const char *LCD_text_wrap(const Font *font, const char *text, size_t max_width, LCD_TextLine *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
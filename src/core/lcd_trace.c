@@ -0,0 +1,169 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lcd_trace.h"
+
+#include <string.h>
+
+static void put_le(uint8_t *dest, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; i++) {
+    dest[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+// Make room for `length` bytes, flushing the buffer if needed.
+static bool reserve(LCD_Trace *trace, size_t length) {
+  if (trace->length + length > trace->size) {
+    LCD_trace_flush(trace);
+  }
+  return trace->length + length <= trace->size;
+}
+
+static void append(LCD_Trace *trace, const uint8_t *data, size_t length) {
+  while (length) {
+    if (trace->length == trace->size) {
+      LCD_trace_flush(trace);
+    }
+    size_t chunk = trace->size - trace->length < length ? trace->size - trace->length : length;
+    memcpy(trace->buffer + trace->length, data, chunk);
+    trace->length += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+// Append a record followed by `length` bytes of data, the record is dropped when the buffer can't be flushed and the
+// data doesn't fit with it.
+static void record(LCD_Trace *trace, LCD_TraceEvent event, uint32_t value, uint64_t start, const uint8_t *data,
+                   size_t length) {
+  uint64_t duration = trace->clock_ns(trace->user) - start;
+  if (!reserve(trace, LCD_TRACE_RECORD_SIZE + (trace->flush ? 0 : length))) {
+    trace->dropped++;
+    return;
+  }
+
+  uint8_t *dest = trace->buffer + trace->length;
+  memset(dest, 0, LCD_TRACE_RECORD_SIZE);
+  dest[0] = (uint8_t)event;
+  dest[1] = data ? LCD_TRACE_FLAG_DATA : 0;
+  put_le(dest + 4, value, 4);
+  put_le(dest + 8, start, 8);
+  put_le(dest + 16, duration > UINT32_MAX ? UINT32_MAX : duration, 4);
+  trace->length += LCD_TRACE_RECORD_SIZE;
+  append(trace, data, length);
+}
+
+static uint32_t trace_spi_write(void *handle, uint8_t *data, size_t len) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  uint64_t start   = trace->clock_ns(trace->user);
+  uint32_t result  = trace->target->spi_write(trace->target->handle, data, len);
+  if (trace->capture_data) {
+    record(trace, LCD_TraceSpiWrite, (uint32_t)len, start, data, len);
+  } else {
+    record(trace, LCD_TraceSpiWrite, (uint32_t)len, start, NULL, 0);
+  }
+  return result;
+}
+
+static uint32_t trace_spi_read(void *handle, uint8_t *data, size_t len) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  uint64_t start   = trace->clock_ns(trace->user);
+  uint32_t result  = trace->target->spi_read(trace->target->handle, data, len);
+  record(trace, LCD_TraceSpiRead, (uint32_t)len, start, NULL, 0);
+  return result;
+}
+
+static uint32_t trace_gpio_write(void *handle, bool cs_high, bool dc_high) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  uint64_t start   = trace->clock_ns(trace->user);
+  uint32_t result  = trace->target->gpio_write(trace->target->handle, cs_high, dc_high);
+  record(trace, LCD_TraceGpioWrite, (uint32_t)cs_high | (uint32_t)dc_high << 1, start, NULL, 0);
+  return result;
+}
+
+static uint32_t trace_reset(void *handle) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  uint64_t start   = trace->clock_ns(trace->user);
+  uint32_t result  = trace->target->reset(trace->target->handle);
+  record(trace, LCD_TraceReset, 0, start, NULL, 0);
+  return result;
+}
+
+static void trace_set_backlight_pwm(void *handle, uint8_t pwm) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  uint64_t start   = trace->clock_ns(trace->user);
+  trace->target->set_backlight_pwm(trace->target->handle, pwm);
+  record(trace, LCD_TraceBacklight, pwm, start, NULL, 0);
+}
+
+static void trace_timer_delay(void *handle, uint32_t millis) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  uint64_t start   = trace->clock_ns(trace->user);
+  trace->target->timer_delay(trace->target->handle, millis);
+  record(trace, LCD_TraceDelay, millis, start, NULL, 0);
+}
+
+// The profiling calls are passed through without being recorded.
+static void trace_profile_begin(void *handle, uint32_t op) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  trace->target->profile_begin(trace->target->handle, op);
+}
+
+static void trace_profile_end(void *handle, uint32_t op) {
+  LCD_Trace *trace = (LCD_Trace *)handle;
+  trace->target->profile_end(trace->target->handle, op);
+}
+
+Result LCD_trace_init(LCD_Trace *trace, LCD_Interface *target, uint8_t *buffer, size_t size,
+                      uint64_t (*clock_ns)(void *user), void (*flush)(void *user, const uint8_t *data, size_t length),
+                      void *user) {
+  if (trace == NULL || target == NULL || buffer == NULL) {
+    return (Result){.code = ErrorNullArgs};
+  }
+  if (clock_ns == NULL) {
+    return (Result){.code = ErrorNullCallback};
+  }
+  if (size < LCD_TRACE_HEADER_SIZE + LCD_TRACE_RECORD_SIZE) {
+    return (Result){.code = ErrorOperationFailed};
+  }
+
+  trace->interface = (LCD_Interface){
+      .handle            = trace,
+      .spi_write         = target->spi_write ? trace_spi_write : NULL,
+      .spi_read          = target->spi_read ? trace_spi_read : NULL,
+      .gpio_write        = target->gpio_write ? trace_gpio_write : NULL,
+      .reset             = target->reset ? trace_reset : NULL,
+      .set_backlight_pwm = target->set_backlight_pwm ? trace_set_backlight_pwm : NULL,
+      .timer_delay       = target->timer_delay ? trace_timer_delay : NULL,
+      .profile_begin     = target->profile_begin ? trace_profile_begin : NULL,
+      .profile_end       = target->profile_end ? trace_profile_end : NULL,
+  };
+  trace->target       = target;
+  trace->clock_ns     = clock_ns;
+  trace->flush        = flush;
+  trace->user         = user;
+  trace->buffer       = buffer;
+  trace->size         = size;
+  trace->dropped      = 0;
+  trace->capture_data = false;
+
+  memcpy(buffer, "LCDT", 4);
+  put_le(buffer + 4, LCD_TRACE_VERSION, 4);
+  trace->length = LCD_TRACE_HEADER_SIZE;
+  return (Result){.code = ErrorOk};
+}
+
+void LCD_trace_mark_frame(LCD_Trace *trace) {
+  record(trace, LCD_TraceFrame, 0, trace->clock_ns(trace->user), NULL, 0);
+}
+
+void LCD_trace_flush(LCD_Trace *trace) {
+  if (trace->flush == NULL) {
+    return;
+  }
+  if (trace->length) {
+    trace->flush(trace->user, trace->buffer, trace->length);
+  }
+  trace->length = 0;
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DISPLAY_DRIVERS_COMMON_TRACE_H_
+#define DISPLAY_DRIVERS_COMMON_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lcd_base.h"
+
+/**
+ * Binary trace of the calls a driver makes to its `LCD_Interface`.
+ *
+ * The trace starts with a header of `LCD_TRACE_HEADER_SIZE` bytes: the magic "LCDT" and the format version as a
+ * little endian `uint32_t`. It is followed by records of `LCD_TRACE_RECORD_SIZE` bytes, all little endian:
+ *
+ *   offset 0   uint8_t  event, see `LCD_TraceEvent`
+ *   offset 1   uint8_t  flags, see `LCD_TRACE_FLAG_DATA`
+ *   offset 2   uint16_t reserved, 0
+ *   offset 4   uint32_t value, see `LCD_TraceEvent`
+ *   offset 8   uint64_t start of the call in nanoseconds
+ *   offset 16  uint32_t duration of the call in nanoseconds
+ *
+ * `tools/lcdtrace` converts a trace to the Chrome trace event format and `st7735_driver_simulator_replay` draws the
+ * traces with data in the simulator.
+ */
+#define LCD_TRACE_VERSION 1
+#define LCD_TRACE_HEADER_SIZE 8
+#define LCD_TRACE_RECORD_SIZE 20
+
+/** The record is followed by the `value` bytes written, see `LCD_Trace.capture_data`. */
+#define LCD_TRACE_FLAG_DATA 0x01
+
+typedef enum {
+  LCD_TraceSpiWrite = 0, /*!< Value: number of bytes written. */
+  LCD_TraceSpiRead,      /*!< Value: number of bytes read. */
+  LCD_TraceGpioWrite,    /*!< Value: bit 0 set if CS is high and bit 1 set if D/C is high. */
+  LCD_TraceReset,        /*!< Value: 0. */
+  LCD_TraceBacklight,    /*!< Value: the PWM. */
+  LCD_TraceDelay,        /*!< Value: the requested delay in milliseconds. */
+  LCD_TraceFrame,        /*!< Value: 0, added by `LCD_trace_mark_frame`. */
+} LCD_TraceEvent;
+
+/**
+ * @brief Interface shim recording the calls to another interface, see `LCD_trace_init`.
+ */
+typedef struct LCD_Trace_st {
+  LCD_Interface interface;                                       /*!< Interface to be given to the driver.*/
+  LCD_Interface *target;                                         /*!< Interface that does the calls.*/
+  uint64_t (*clock_ns)(void *user);                              /*!< Monotonic time in nanoseconds.*/
+  void (*flush)(void *user, const uint8_t *data, size_t length); /*!< Receives the trace when the buffer is full.*/
+  void *user;                                                    /*!< Passed to `clock_ns` and `flush`.*/
+  uint8_t *buffer;                                               /*!< Records not flushed yet.*/
+  size_t size;                                                   /*!< Size of the buffer in bytes.*/
+  size_t length;                                                 /*!< Bytes used in the buffer.*/
+  size_t dropped;                                                /*!< Records lost because the buffer was full.*/
+  bool capture_data;                                             /*!< Store the bytes written after the records of
+                                                                      `spi_write`, to replay the trace. False after
+                                                                      `LCD_trace_init`.*/
+} LCD_Trace;
+
+/**
+ * @brief Initialize a trace recorder.
+ *
+ * The driver is initialized with `&trace->interface`, whose callbacks time the calls to `target` and append a record
+ * for each one. The callbacks `target` doesn't have are left NULL. When the buffer is full it is passed to `flush`
+ * and reused, without `flush` the trace stops and the records that don't fit are counted in `dropped`. The data
+ * captured with `capture_data` may be larger than the buffer, in which case it is passed to `flush` in pieces.
+ *
+ * @param trace The recorder.
+ * @param target The interface recorded.
+ * @param buffer Buffer for the records, at least `LCD_TRACE_HEADER_SIZE + LCD_TRACE_RECORD_SIZE` bytes.
+ * @param size Size of the buffer in bytes.
+ * @param clock_ns Function returning a monotonic time in nanoseconds.
+ * @param flush Function receiving the trace data, can be NULL.
+ * @param user Pointer passed to `clock_ns` and `flush`.
+ * @return Result of the operation.
+ */
+Result LCD_trace_init(LCD_Trace *trace, LCD_Interface *target, uint8_t *buffer, size_t size,
+                      uint64_t (*clock_ns)(void *user), void (*flush)(void *user, const uint8_t *data, size_t length),
+                      void *user);
+
+/**
+ * @brief Add a record marking the end of a frame, so the frames can be told apart in the trace.
+ */
+void LCD_trace_mark_frame(LCD_Trace *trace);
+
+/**
+ * @brief Pass the records in the buffer to `flush` and empty it, nothing is done without `flush`.
+ */
+void LCD_trace_flush(LCD_Trace *trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
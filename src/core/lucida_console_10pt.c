@@ -1544,4 +1544,8 @@ const Font lucidaConsole_10ptFont = {
     '~',                            //  End character
     lucidaConsole_10ptDescriptors,  //  Character descriptor array
     lucidaConsole_10ptBitmaps,      //  Character bitmap array
+    8,                              //  Fixed width, 0 if proportional
+    0,                              //  Code point ranges
+    0,                              //  Number of code point ranges
+    FontEncodingBitmap,             //  Bitmap encoding
 };
\ No newline at end of file
@@ -1828,4 +1828,8 @@ const Font lucidaConsole_12ptFont = {
     '~',                            //  End character
     lucidaConsole_12ptDescriptors,  //  Character descriptor array
     lucidaConsole_12ptBitmaps,      //  Character bitmap array
+    10,                             //  Fixed width, 0 if proportional
+    0,                              //  Code point ranges
+    0,                              //  Number of code point ranges
+    FontEncodingBitmap,             //  Bitmap encoding
 };
\ No newline at end of file
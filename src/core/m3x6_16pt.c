@@ -1067,4 +1067,8 @@ const Font m3x6_16ptFont = {
     '~',                   //  End character
     m3x6_16ptDescriptors,  //  Character descriptor array
     m3x6_16ptBitmaps,      //  Character bitmap array
+    0,                     //  Fixed width, 0 if proportional
+    0,                     //  Code point ranges
+    0,                     //  Number of code point ranges
+    FontEncodingBitmap,    //  Bitmap encoding
 };
@@ -1162,4 +1162,8 @@ const Font m5x7_16ptFont = {
     '~',                   //  End character
     m5x7_16ptDescriptors,  //  Character descriptor array
     m5x7_16ptBitmaps,      //  Character bitmap array
+    0,                     //  Fixed width, 0 if proportional
+    0,                     //  Code point ranges
+    0,                     //  Number of code point ranges
+    FontEncodingBitmap,    //  Bitmap encoding
 };
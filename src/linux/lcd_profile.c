@@ -0,0 +1,167 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lcd_profile.h"
+
+#include <string.h>
+#include <time.h>
+
+static uint64_t monotonic_ns(void *user) {
+  (void)user;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+// Histogram bucket of a latency: exact below 8ns, then 8 buckets per power of two.
+static size_t bucket(uint64_t ns) {
+  if (ns < 8) {
+    return (size_t)ns;
+  }
+  size_t exponent = 63 - (size_t)__builtin_clzll(ns);
+  size_t index    = (exponent - 2) * 8 + (size_t)((ns >> (exponent - 3)) & 0x07);
+  return index < LCD_PROFILE_BUCKETS ? index : LCD_PROFILE_BUCKETS - 1;
+}
+
+// Largest latency counted in a bucket.
+static uint64_t bucket_limit(size_t index) {
+  if (index < 8) {
+    return index;
+  }
+  size_t exponent = index / 8 + 2;
+  return ((uint64_t)(8 + index % 8 + 1) << (exponent - 3)) - 1;
+}
+
+// Smallest latency that at least `fraction` of the calls don't exceed, rounded up to the limit of its bucket.
+static uint64_t percentile(const LCD_ProfileOp *op, double fraction) {
+  uint64_t rank  = (uint64_t)(fraction * (double)op->count + 0.999999);
+  uint64_t calls = 0;
+  for (size_t i = 0; i < LCD_PROFILE_BUCKETS; i++) {
+    calls += op->buckets[i];
+    if (calls >= rank) {
+      uint64_t limit = bucket_limit(i);
+      return limit < op->max_ns ? limit : op->max_ns;
+    }
+  }
+  return op->max_ns;
+}
+
+static uint32_t profile_spi_write(void *handle, uint8_t *data, size_t len) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  return profile->target->spi_write(profile->target->handle, data, len);
+}
+
+static uint32_t profile_spi_read(void *handle, uint8_t *data, size_t len) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  return profile->target->spi_read(profile->target->handle, data, len);
+}
+
+static uint32_t profile_gpio_write(void *handle, bool cs_high, bool dc_high) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  return profile->target->gpio_write(profile->target->handle, cs_high, dc_high);
+}
+
+static uint32_t profile_reset(void *handle) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  return profile->target->reset(profile->target->handle);
+}
+
+static void profile_set_backlight_pwm(void *handle, uint8_t pwm) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  profile->target->set_backlight_pwm(profile->target->handle, pwm);
+}
+
+static void profile_timer_delay(void *handle, uint32_t millis) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  profile->target->timer_delay(profile->target->handle, millis);
+}
+
+static void profile_begin(void *handle, uint32_t op) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  if (profile->target->profile_begin) {
+    profile->target->profile_begin(profile->target->handle, op);
+  }
+  if (op < LCD_PROFILE_MAX_OPS && profile->ops[op].depth++ == 0) {
+    profile->ops[op].start_ns = profile->clock_ns(profile->user);
+  }
+}
+
+static void profile_end(void *handle, uint32_t op) {
+  LCD_Profile *profile = (LCD_Profile *)handle;
+  if (op < LCD_PROFILE_MAX_OPS && profile->ops[op].depth && --profile->ops[op].depth == 0) {
+    LCD_ProfileOp *measured = &profile->ops[op];
+    uint64_t ns             = profile->clock_ns(profile->user) - measured->start_ns;
+    measured->count++;
+    measured->total_ns += ns;
+    measured->max_ns = ns > measured->max_ns ? ns : measured->max_ns;
+    measured->buckets[bucket(ns)]++;
+  }
+  if (profile->target->profile_end) {
+    profile->target->profile_end(profile->target->handle, op);
+  }
+}
+
+Result LCD_profile_init(LCD_Profile *profile, LCD_Interface *target) {
+  if (profile == NULL || target == NULL) {
+    return (Result){.code = ErrorNullArgs};
+  }
+
+  profile->interface = (LCD_Interface){
+      .handle            = profile,
+      .spi_write         = target->spi_write ? profile_spi_write : NULL,
+      .spi_read          = target->spi_read ? profile_spi_read : NULL,
+      .gpio_write        = target->gpio_write ? profile_gpio_write : NULL,
+      .reset             = target->reset ? profile_reset : NULL,
+      .set_backlight_pwm = target->set_backlight_pwm ? profile_set_backlight_pwm : NULL,
+      .timer_delay       = target->timer_delay ? profile_timer_delay : NULL,
+      .profile_begin     = profile_begin,
+      .profile_end       = profile_end,
+  };
+  profile->target   = target;
+  profile->clock_ns = monotonic_ns;
+  profile->user     = NULL;
+  LCD_profile_reset(profile);
+  return (Result){.code = ErrorOk};
+}
+
+void LCD_profile_reset(LCD_Profile *profile) { memset(profile->ops, 0, sizeof(profile->ops)); }
+
+Result LCD_profile_stats(const LCD_Profile *profile, uint32_t op, LCD_ProfileStats *stats) {
+  if (profile == NULL || stats == NULL) {
+    return (Result){.code = ErrorNullArgs};
+  }
+  memset(stats, 0, sizeof(*stats));
+  if (op >= LCD_PROFILE_MAX_OPS) {
+    return (Result){.code = ErrorOperationFailed};
+  }
+
+  const LCD_ProfileOp *measured = &profile->ops[op];
+  if (measured->count) {
+    stats->count    = measured->count;
+    stats->total_ns = measured->total_ns;
+    stats->p50_ns   = percentile(measured, 0.50);
+    stats->p99_ns   = percentile(measured, 0.99);
+    stats->max_ns   = measured->max_ns;
+  }
+  return (Result){.code = ErrorOk};
+}
+
+void LCD_profile_report(const LCD_Profile *profile, FILE *file, const char *(*op_name)(uint32_t op)) {
+  fprintf(file, "%-32s %10s %12s %12s %12s %12s\n", "operation", "calls", "p50 us", "p99 us", "max us", "total ms");
+  for (uint32_t op = 0; op < LCD_PROFILE_MAX_OPS; op++) {
+    LCD_ProfileStats stats;
+    LCD_profile_stats(profile, op, &stats);
+    if (stats.count == 0) {
+      continue;
+    }
+    const char *name = op_name ? op_name(op) : NULL;
+    if (name) {
+      fprintf(file, "%-32s", name);
+    } else {
+      fprintf(file, "%-32u", op);
+    }
+    fprintf(file, " %10llu %12.3f %12.3f %12.3f %12.3f\n", (unsigned long long)stats.count, stats.p50_ns / 1e3,
+            stats.p99_ns / 1e3, stats.max_ns / 1e3, stats.total_ns / 1e6);
+  }
+}
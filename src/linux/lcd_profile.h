@@ -0,0 +1,103 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DISPLAY_DRIVERS_LINUX_PROFILE_H_
+#define DISPLAY_DRIVERS_LINUX_PROFILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../core/lcd_base.h"
+
+#ifndef LCD_PROFILE_MAX_OPS
+// Number of operation identifiers measured, the calls with larger identifiers are ignored.
+#define LCD_PROFILE_MAX_OPS 32
+#endif
+
+/**
+ * Latency histograms of the driver functions, built from the `profile_begin` and `profile_end` callbacks.
+ *
+ * The latencies below 8ns are counted exactly and the larger ones in 8 buckets per power of two, so the percentiles
+ * are rounded up by at most 12.5%. Latencies from 2^40ns (18 minutes) on share the last bucket.
+ */
+#define LCD_PROFILE_BUCKETS ((40 - 2) * 8)
+
+typedef struct LCD_ProfileOp_st {
+  uint64_t count;                        /*!< Calls measured.*/
+  uint64_t total_ns;                     /*!< Sum of the latencies.*/
+  uint64_t max_ns;                       /*!< Largest latency.*/
+  uint64_t start_ns;                     /*!< Start of the call in progress.*/
+  uint32_t depth;                        /*!< Nesting of the calls in progress.*/
+  uint32_t buckets[LCD_PROFILE_BUCKETS]; /*!< Histogram of the latencies.*/
+} LCD_ProfileOp;
+
+/**
+ * @brief Interface shim measuring the driver functions, see `LCD_profile_init`.
+ */
+typedef struct LCD_Profile_st {
+  LCD_Interface interface;                /*!< Interface to be given to the driver.*/
+  LCD_Interface *target;                  /*!< Interface that does the calls.*/
+  uint64_t (*clock_ns)(void *user);       /*!< Monotonic time in nanoseconds, `CLOCK_MONOTONIC` after
+                                               `LCD_profile_init`, it can be replaced.*/
+  void *user;                             /*!< Passed to `clock_ns`.*/
+  LCD_ProfileOp ops[LCD_PROFILE_MAX_OPS]; /*!< Measurements per operation identifier.*/
+} LCD_Profile;
+
+/**
+ * @brief Latency summary of an operation, in nanoseconds.
+ */
+typedef struct LCD_ProfileStats_st {
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t p50_ns;
+  uint64_t p99_ns;
+  uint64_t max_ns;
+} LCD_ProfileStats;
+
+/**
+ * @brief Initialize a profiler.
+ *
+ * The driver is initialized with `&profile->interface`, whose callbacks pass the calls to `target` and whose
+ * `profile_begin` and `profile_end` measure the driver functions with `clock_gettime`. The profiling callbacks of
+ * `target`, if any, are called as well. A recursive call to the same operation is measured from its outermost call.
+ *
+ * @param profile The profiler, about 40KB with the default `LCD_PROFILE_MAX_OPS`.
+ * @param target The interface driving the display.
+ * @return Result of the operation.
+ */
+Result LCD_profile_init(LCD_Profile *profile, LCD_Interface *target);
+
+/**
+ * @brief Forget the measurements.
+ */
+void LCD_profile_reset(LCD_Profile *profile);
+
+/**
+ * @brief Summarize the latencies of an operation.
+ *
+ * @param profile The profiler.
+ * @param op The operation identifier, e.g. a `St7735Op`.
+ * @param[out] stats The summary, all zero if the operation was not called.
+ * @return Result of the operation.
+ */
+Result LCD_profile_stats(const LCD_Profile *profile, uint32_t op, LCD_ProfileStats *stats);
+
+/**
+ * @brief Print a table with the summary of each operation called.
+ *
+ * @param profile The profiler.
+ * @param file Output, e.g. `stdout`.
+ * @param op_name Function naming the operations, e.g. `lcd_st7735_op_name`, can be NULL to print the identifiers.
+ */
+void LCD_profile_report(const LCD_Profile *profile, FILE *file, const char *(*op_name)(uint32_t op));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,24 +6,69 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "lcd_st7735_cmds.h"
 #include "lcd_st7735_init.h"
 
+#if LCD_ST7735_COUNTERS
+#define COUNT(field, value) (ctx->counters.field += (value))
+// Attribute the pixels written from now on to a group of functions.
+#define COUNT_API(api) (ctx->counter_api = (api))
+#else
+#define COUNT(field, value) ((void)0)
+#define COUNT_API(api) ((void)0)
+#endif
+
 // clang-format on
+static inline void profile_begin(St7735Context *ctx, St7735Op op) {
+  LCD_Interface *interface = ctx->parent.interface;
+  if (interface->profile_begin) {
+    interface->profile_begin(interface->handle, op);
+  }
+}
+
+// Close the operation started with `profile_begin` and pass its result through, for the return statements.
+static inline Result profile_end(St7735Context *ctx, St7735Op op, Result result) {
+  LCD_Interface *interface = ctx->parent.interface;
+  if (interface->profile_end) {
+    interface->profile_end(interface->handle, op);
+  }
+  return result;
+}
+
+static inline void write_pins(St7735Context *ctx, bool cs_high, bool dc_high) {
+  COUNT(gpio_writes, 1);
+  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, cs_high, dc_high);
+}
+
 static void write_command(St7735Context *ctx, uint8_t command) {
   uint16_t value = (command & 0x00FF);
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, false);
+  write_pins(ctx, false, false);
   ctx->parent.interface->spi_write(ctx->parent.interface->handle, (uint8_t *)&value, 1);
+  COUNT(commands, 1);
+  COUNT(spi_writes, 1);
+  COUNT(bytes, 1);
+#if LCD_ST7735_COUNTERS
+  ctx->counter_ramwr = command == ST7735_RAMWR;
+#endif
 }
 
 static void write_buffer(St7735Context *ctx, const uint8_t *buffer, size_t length) {
   if (length) {
     ctx->parent.interface->spi_write(ctx->parent.interface->handle, (uint8_t *)buffer, length);
+    COUNT(spi_writes, 1);
+    COUNT(bytes, length);
+#if LCD_ST7735_COUNTERS
+    if (ctx->counter_ramwr) {
+      ctx->counters.pixels[ctx->counter_api] += length / sizeof(uint16_t);
+    }
+#endif
   }
 }
 
 static inline void delay(St7735Context *ctx, uint32_t millisecond) {
+  COUNT(delay_ms, millisecond);
   ctx->parent.interface->timer_delay(ctx->parent.interface->handle, millisecond);
 }
 
@@ -40,9 +85,9 @@ static void run_script(St7735Context *ctx, const uint8_t *addr) {
     delay_ms = numArgs & DELAY;  // If hibit set, delay follows args
     numArgs &= ~DELAY;           // Mask out delay bit
 
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+    write_pins(ctx, false, true);
     write_buffer(ctx, addr, numArgs);
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
+    write_pins(ctx, true, true);
     addr += numArgs;
 
     if (delay_ms) {
@@ -54,6 +99,7 @@ static void run_script(St7735Context *ctx, const uint8_t *addr) {
 }
 
 static void set_address(St7735Context *ctx, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+  COUNT(windows, 1);
   y0 += ctx->row_offset;
   y1 += ctx->row_offset;
   x0 += ctx->col_offset;
@@ -62,16 +108,16 @@ static void set_address(St7735Context *ctx, uint32_t x0, uint32_t y0, uint32_t x
   {
     uint8_t coordinate[4] = {(uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1};
     write_command(ctx, ST7735_CASET);  // Column addr set
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+    write_pins(ctx, false, true);
     write_buffer(ctx, coordinate, sizeof(coordinate));
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
+    write_pins(ctx, true, true);
   }
   {
     uint8_t coordinate[4] = {(uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1};
     write_command(ctx, ST7735_RASET);  // Row addr set
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+    write_pins(ctx, false, true);
     write_buffer(ctx, coordinate, sizeof(coordinate));
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
+    write_pins(ctx, true, true);
   }
 
   write_command(ctx, ST7735_RAMWR);  // write to RAM
@@ -79,86 +125,111 @@ static void set_address(St7735Context *ctx, uint32_t x0, uint32_t y0, uint32_t x
 
 static void write_register(St7735Context *ctx, uint8_t addr, uint8_t value) {
   write_command(ctx, addr);
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+  write_pins(ctx, false, true);
   write_buffer(ctx, (uint8_t *)&value, sizeof(value));
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
+  write_pins(ctx, true, true);
 }
 
-static uint8_t set_orientation(St7735Context *ctx, LCD_Orientation orientation) {
-  uint8_t madctl          = 0;
-  ctx->parent.orientation = orientation;
+// MADCTL address mode of each orientation.
+static uint8_t orientation_madctl(LCD_Orientation orientation) {
   switch (orientation) {
     case LCD_Rotate0:
-      madctl = ST77_MADCTL_MV | ST77_MADCTL_MX;
-      break;
+      return ST77_MADCTL_MV | ST77_MADCTL_MX;
     case LCD_Rotate90:
-      madctl = ST77_MADCTL_MX | ST77_MADCTL_MY;
-      SWAP(ctx->parent.width, ctx->parent.height, size_t);
-      SWAP(ctx->col_offset, ctx->row_offset, size_t);
-      break;
+      return ST77_MADCTL_MX | ST77_MADCTL_MY;
     case LCD_Rotate180:
-      madctl = ST77_MADCTL_MV | ST77_MADCTL_MY;
-      break;
+      return ST77_MADCTL_MV | ST77_MADCTL_MY;
     case LCD_Rotate270:
-      SWAP(ctx->parent.width, ctx->parent.height, size_t);
-      SWAP(ctx->col_offset, ctx->row_offset, size_t);
-      break;
     default:
-      break;
+      return 0;
+  }
+}
+
+static uint8_t set_orientation(St7735Context *ctx, LCD_Orientation orientation) {
+  ctx->parent.orientation = orientation;
+  if (orientation == LCD_Rotate90 || orientation == LCD_Rotate270) {
+    SWAP(ctx->parent.width, ctx->parent.height, size_t);
+    SWAP(ctx->col_offset, ctx->row_offset, size_t);
+  }
+  return orientation_madctl(orientation);
+}
+
+// Write MADCTL unless it already holds the value.
+static void write_madctl(St7735Context *ctx, uint8_t madctl) {
+  if (ctx->madctl != madctl) {
+    write_register(ctx, ST7735_MADCTL, madctl);
+    ctx->madctl = madctl;
   }
-  return madctl;
 }
 
 Result lcd_st7735_init(St7735Context *ctx, LCD_Interface *interface) {
   LCD_Init(&ctx->parent, interface, 160, 128, LCD_Rotate0);
+  // The interface is known from here on.
+  profile_begin(ctx, St7735OpInit);
   lcd_st7735_set_font_colors(ctx, 0xFFFFFF, 0x000000);
   ctx->col_offset = ctx->row_offset = 0;
 
-  return (Result){.code = 0};
+  ctx->mono_lut.valid = false;
+  // Reset value of the controller.
+  ctx->madctl = 0;
+  lcd_st7735_reset_counters(ctx);
+
+  return profile_end(ctx, St7735OpInit, (Result){.code = 0});
 }
 
 Result lcd_st7735_startup(St7735Context *ctx) {
+  profile_begin(ctx, St7735OpStartup);
   int32_t result = 0;
 
   run_script(ctx, init_script_b);
   run_script(ctx, init_script_r);
   run_script(ctx, init_script_r3);
+  // Address mode set by the scripts.
+  ctx->madctl = orientation_madctl(LCD_Rotate0) | ST77_MADCTL_RGB;
 
-  return (Result){.code = result};
+  return profile_end(ctx, St7735OpStartup, (Result){.code = result});
 }
 
 Result lcd_st7735_set_orientation(St7735Context *ctx, LCD_Orientation orientation) {
+  profile_begin(ctx, St7735OpSetOrientation);
   uint8_t madctl = set_orientation(ctx, orientation);
 
-  write_register(ctx, ST7735_MADCTL, madctl | ST77_MADCTL_RGB);
+  write_madctl(ctx, madctl | ST77_MADCTL_RGB);
 
-  return (Result){.code = 0};
+  return profile_end(ctx, St7735OpSetOrientation, (Result){.code = 0});
 }
 
 Result lcd_st7735_clean(St7735Context *ctx) {
+  profile_begin(ctx, St7735OpClean);
   size_t w, h;
   lcd_st7735_get_resolution(ctx, &h, &w);
-  return lcd_st7735_fill_rectangle(ctx, (LCD_rectangle){.origin = {.x = 0, .y = 0}, .width = w, .height = h}, 0xffffff);
+  Result result =
+      lcd_st7735_fill_rectangle(ctx, (LCD_rectangle){.origin = {.x = 0, .y = 0}, .width = w, .height = h}, 0xffffff);
+  return profile_end(ctx, St7735OpClean, result);
 }
 
 Result lcd_st7735_draw_pixel(St7735Context *ctx, LCD_Point pixel, uint32_t color) {
+  profile_begin(ctx, St7735OpDrawPixel);
+  COUNT_API(St7735ApiPixel);
   if ((pixel.x < 0) || (pixel.x >= ctx->parent.width) || (pixel.y < 0) || (pixel.y >= ctx->parent.height)) {
-    return (Result){.code = -1};
+    return profile_end(ctx, St7735OpDrawPixel, (Result){.code = -1});
   }
   color = LCD_rgb24_to_bgr565(color);
 
   set_address(ctx, pixel.x, pixel.y, pixel.x + 1, pixel.y + 1);
 
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+  write_pins(ctx, false, true);
   write_buffer(ctx, (uint8_t *)&color, 2);
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawPixel, (Result){.code = 0});
 }
 
 Result lcd_st7735_draw_vertical_line(St7735Context *ctx, LCD_Line line, uint32_t color) {
+  profile_begin(ctx, St7735OpDrawVerticalLine);
+  COUNT_API(St7735ApiLine);
   // Rudimentary clipping
   if ((line.origin.x >= ctx->parent.width) || (line.origin.y >= ctx->parent.height)) {
-    return (Result){.code = -1};
+    return profile_end(ctx, St7735OpDrawVerticalLine, (Result){.code = -1});
   }
 
   if ((line.origin.y + line.length - 1) >= ctx->parent.height) {
@@ -168,18 +239,20 @@ Result lcd_st7735_draw_vertical_line(St7735Context *ctx, LCD_Line line, uint32_t
   color = LCD_rgb24_to_bgr565(color);
   set_address(ctx, line.origin.x, line.origin.y, line.origin.x, line.origin.y + line.length - 1);
 
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+  write_pins(ctx, false, true);
   while (line.length--) {
     write_buffer(ctx, (uint8_t *)&color, 2);
   }
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawVerticalLine, (Result){.code = 0});
 }
 
 Result lcd_st7735_draw_horizontal_line(St7735Context *ctx, LCD_Line line, uint32_t color) {
+  profile_begin(ctx, St7735OpDrawHorizontalLine);
+  COUNT_API(St7735ApiLine);
   // Rudimentary clipping
   if ((line.origin.x >= ctx->parent.width) || (line.origin.y >= ctx->parent.height)) {
-    return (Result){.code = -1};
+    return profile_end(ctx, St7735OpDrawHorizontalLine, (Result){.code = -1});
   }
 
   if ((line.origin.x + line.length - 1) >= ctx->parent.width) {
@@ -190,20 +263,22 @@ Result lcd_st7735_draw_horizontal_line(St7735Context *ctx, LCD_Line line, uint32
 
   color = LCD_rgb24_to_bgr565(color);
 
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+  write_pins(ctx, false, true);
   while (line.length--) {
     write_buffer(ctx, (uint8_t *)&color, 2);
   }
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawHorizontalLine, (Result){.code = 0});
 }
 
 Result lcd_st7735_fill_rectangle(St7735Context *ctx, LCD_rectangle rectangle, uint32_t color) {
+  profile_begin(ctx, St7735OpFillRectangle);
+  COUNT_API(St7735ApiFill);
   // rudimentary clipping (drawChar w/big text requires this)
   if ((rectangle.origin.x >= ctx->parent.width) || (rectangle.origin.y >= ctx->parent.height) ||
       (rectangle.origin.x + rectangle.width > ctx->parent.width) ||
       (rectangle.origin.y + rectangle.height > ctx->parent.height)) {
-    return (Result){.code = -1};
+    return profile_end(ctx, St7735OpFillRectangle, (Result){.code = -1});
   }
 
   uint16_t w = (uint16_t)(MIN(rectangle.origin.x + rectangle.width, ctx->parent.width) - rectangle.origin.x);
@@ -219,112 +294,796 @@ Result lcd_st7735_fill_rectangle(St7735Context *ctx, LCD_rectangle rectangle, ui
 
   set_address(ctx, rectangle.origin.x, rectangle.origin.y, rectangle.origin.x + w - 1, rectangle.origin.y + h - 1);
 
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+  write_pins(ctx, false, true);
   // Iterate through the lines.
   for (int x = h; x > 0; x--) {
     write_buffer(ctx, (uint8_t *)row, sizeof(row));
   }
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpFillRectangle, (Result){.code = 0});
+}
+
+Result lcd_st7735_render_region(St7735Context *ctx, LCD_rectangle rectangle, LCD_LineCallback line_cb, void *user) {
+  profile_begin(ctx, St7735OpRenderRegion);
+  COUNT_API(St7735ApiRegion);
+  if (line_cb == NULL) {
+    return profile_end(ctx, St7735OpRenderRegion, (Result){.code = ErrorNullArgs});
+  }
+
+  if ((rectangle.origin.x >= ctx->parent.width) || (rectangle.origin.y >= ctx->parent.height) ||
+      (rectangle.origin.x + rectangle.width > ctx->parent.width) ||
+      (rectangle.origin.y + rectangle.height > ctx->parent.height) || rectangle.width == 0 || rectangle.height == 0) {
+    return profile_end(ctx, St7735OpRenderRegion, (Result){.code = -1});
+  }
+
+  // Two line buffers are used alternately, so the callback never overwrites the row handed to the previous
+  // `spi_write`, which allows DMA based transports to send one row while the next one is generated.
+  uint16_t lines[2][rectangle.width];
+
+  set_address(ctx, rectangle.origin.x, rectangle.origin.y, rectangle.origin.x + rectangle.width - 1,
+              rectangle.origin.y + rectangle.height - 1);
+
+  write_pins(ctx, false, true);
+  for (size_t row = 0; row < rectangle.height; row++) {
+    uint16_t *line = lines[row & 0x01];
+    line_cb(user, row, line, rectangle.width);
+    write_buffer(ctx, (uint8_t *)line, rectangle.width * sizeof(uint16_t));
+  }
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpRenderRegion, (Result){.code = 0});
+}
+
+static void update_mono_lut(St7735Context *ctx, uint16_t foreground, uint16_t background) {
+  if (ctx->mono_lut.valid && ctx->mono_lut.foreground == foreground && ctx->mono_lut.background == background) {
+    return;
+  }
+
+  uint16_t colors[2] = {background, foreground};
+  for (size_t value = 0; value < (1 << LCD_ST7735_MONO_LUT_BITS); value++) {
+    for (size_t bit = 0; bit < LCD_ST7735_MONO_LUT_BITS; bit++) {
+      ctx->mono_lut.pixels[value][bit] = colors[(value >> bit) & 0x01];
+    }
+  }
+  ctx->mono_lut.foreground = foreground;
+  ctx->mono_lut.background = background;
+  ctx->mono_lut.valid      = true;
+}
+
+// Expand a row of 1bpp bits through the lookup table, `line` must have room for `width` rounded up to a whole byte.
+static void expand_mono(St7735Context *ctx, const uint8_t *bits, size_t width, uint16_t *line) {
+  enum {
+    lut_bits = LCD_ST7735_MONO_LUT_BITS,
+    lut_mask = (1 << LCD_ST7735_MONO_LUT_BITS) - 1,
+  };
+
+  for (size_t byte = 0; byte < (width + 7) / 8; byte++) {
+    for (size_t shift = 0; shift < 8; shift += lut_bits, line += lut_bits) {
+      memcpy(line, ctx->mono_lut.pixels[(bits[byte] >> shift) & lut_mask], lut_bits * sizeof(uint16_t));
+    }
+  }
+}
+
+Result lcd_st7735_draw_mono(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *bits, size_t stride,
+                            uint32_t foreground, uint32_t background) {
+  profile_begin(ctx, St7735OpDrawMono);
+  COUNT_API(St7735ApiMono);
+  if (bits == NULL) {
+    return profile_end(ctx, St7735OpDrawMono, (Result){.code = ErrorNullArgs});
+  }
+
+  if ((rectangle.origin.x >= ctx->parent.width) || (rectangle.origin.y >= ctx->parent.height) ||
+      (rectangle.origin.x + rectangle.width > ctx->parent.width) ||
+      (rectangle.origin.y + rectangle.height > ctx->parent.height) || rectangle.width == 0 || rectangle.height == 0) {
+    return profile_end(ctx, St7735OpDrawMono, (Result){.code = -1});
+  }
+
+  update_mono_lut(ctx, LCD_rgb24_to_bgr565(foreground), LCD_rgb24_to_bgr565(background));
+
+  // Rounded up to a whole byte so the last lookup can be copied in full.
+  uint16_t line[rectangle.width + 7];
+
+  set_address(ctx, rectangle.origin.x, rectangle.origin.y, rectangle.origin.x + rectangle.width - 1,
+              rectangle.origin.y + rectangle.height - 1);
+
+  write_pins(ctx, false, true);
+  for (size_t row = 0; row < rectangle.height; row++, bits += stride) {
+    expand_mono(ctx, bits, rectangle.width, line);
+    write_buffer(ctx, (uint8_t *)line, rectangle.width * sizeof(uint16_t));
+  }
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawMono, (Result){.code = 0});
+}
+
+Result lcd_st7735_draw_mono_transparent(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *bits,
+                                        size_t stride, uint32_t foreground) {
+  profile_begin(ctx, St7735OpDrawMonoTransparent);
+  COUNT_API(St7735ApiMono);
+  if (bits == NULL) {
+    return profile_end(ctx, St7735OpDrawMonoTransparent, (Result){.code = ErrorNullArgs});
+  }
+
+  if ((rectangle.origin.x >= ctx->parent.width) || (rectangle.origin.y >= ctx->parent.height) ||
+      (rectangle.origin.x + rectangle.width > ctx->parent.width) ||
+      (rectangle.origin.y + rectangle.height > ctx->parent.height) || rectangle.width == 0 || rectangle.height == 0) {
+    return profile_end(ctx, St7735OpDrawMonoTransparent, (Result){.code = -1});
+  }
+
+  uint16_t color = LCD_rgb24_to_bgr565(foreground);
+  uint16_t run[rectangle.width];
+  for (size_t i = 0; i < rectangle.width; ++i) {
+    run[i] = color;
+  }
+
+  for (size_t row = 0; row < rectangle.height; row++, bits += stride) {
+    size_t x = 0;
+    while (x < rectangle.width) {
+      // Skip the background, a whole byte at a time when possible.
+      if ((x & 0x07) == 0 && bits[x / 8] == 0x00) {
+        x += 8;
+        continue;
+      }
+      if (!(bits[x / 8] & (0x01 << (x & 0x07)))) {
+        x++;
+        continue;
+      }
+
+      size_t start = x;
+      while (x < rectangle.width && (bits[x / 8] & (0x01 << (x & 0x07)))) {
+        x++;
+      }
+      set_address(ctx, rectangle.origin.x + start, rectangle.origin.y + row, rectangle.origin.x + x - 1,
+                  rectangle.origin.y + row);
+      write_pins(ctx, false, true);
+      write_buffer(ctx, (uint8_t *)run, (x - start) * sizeof(uint16_t));
+      write_pins(ctx, true, true);
+    }
+  }
+  return profile_end(ctx, St7735OpDrawMonoTransparent, (Result){.code = 0});
+}
+
+Result lcd_st7735_set_font_colors(St7735Context *ctx, uint32_t background_color, uint32_t foreground_color) {
+  ctx->rgb_background = background_color;
+  ctx->rgb_foreground = foreground_color;
+
+  for (uint32_t coverage = 0; coverage <= LCD_COVERAGE_MAX; coverage++) {
+    uint32_t rgb = 0;
+    for (uint32_t shift = 0; shift < 24; shift += 8) {
+      uint32_t from  = (background_color >> shift) & 0xFF, to = (foreground_color >> shift) & 0xFF;
+      uint32_t blend = from * (LCD_COVERAGE_MAX - coverage) + to * coverage;
+      rgb |= (blend + LCD_COVERAGE_MAX / 2) / LCD_COVERAGE_MAX << shift;
+    }
+    ctx->text_ramp[coverage] = LCD_rgb24_to_bgr565(rgb);
+  }
+
+  return LCD_set_font_colors(&ctx->parent, LCD_rgb24_to_bgr565(background_color),
+                             LCD_rgb24_to_bgr565(foreground_color));
+}
+
+Result lcd_st7735_fill_gradient(St7735Context *ctx, LCD_rectangle rectangle, LCD_GradientType type, uint32_t from,
+                                uint32_t to, bool dither) {
+  profile_begin(ctx, St7735OpFillGradient);
+  LCD_Gradient gradient;
+  LCD_gradient_init(&gradient, type, from, to, rectangle.width, rectangle.height, dither);
+  return profile_end(ctx, St7735OpFillGradient, lcd_st7735_render_region(ctx, rectangle, LCD_gradient_line, &gradient));
+}
+
+Result lcd_st7735_fill_pattern(St7735Context *ctx, LCD_rectangle rectangle, LCD_PatternType type, size_t size,
+                               uint32_t color_a, uint32_t color_b) {
+  profile_begin(ctx, St7735OpFillPattern);
+  LCD_Pattern pattern;
+  LCD_pattern_init(&pattern, type, size, color_a, color_b);
+  return profile_end(ctx, St7735OpFillPattern, lcd_st7735_render_region(ctx, rectangle, LCD_pattern_line, &pattern));
+}
+
+// Approximate bus cost of opening a window, in bytes: the CASET, RASET and RAMWR commands with their parameters plus
+// the D/C toggles between them.
+#define WINDOW_COST 16
+
+static inline bool glyph_pixel(const uint8_t *row, size_t column) {
+  return (row[column / 8] & (0x01 << (column % 8))) != 0;
+}
+
+// Draw only the foreground pixels of a glyph, one window per horizontal run. Each window spans the `scale` rows the
+// glyph row is magnified to, which are sent from a single row of foreground pixels.
+static void putchar_runs(St7735Context *ctx, LCD_Point origin, const FontCharInfo *info, size_t scale) {
+  const Font *font = ctx->parent.font;
+  size_t width     = info->width;
+  uint8_t scratch[LCD_GLYPH_ROW_MAX_BYTES];
+  uint16_t run[width * scale];
+  for (size_t i = 0; i < width * scale; i++) {
+    run[i] = (uint16_t)ctx->parent.foreground_color;
+  }
+
+  for (size_t row = 0; row < font->height; row++) {
+    const uint8_t *bitmap = LCD_font_glyph_row(font, info, row, scratch);
+    size_t column         = 0;
+    while (bitmap != NULL && column < width) {
+      if (!glyph_pixel(bitmap, column)) {
+        column++;
+        continue;
+      }
+      size_t start = column;
+      while (column < width && glyph_pixel(bitmap, column)) {
+        column++;
+      }
+      size_t x = origin.x + start * scale, y = origin.y + row * scale;
+      set_address(ctx, x, y, x + (column - start) * scale - 1, y + scale - 1);
+      write_pins(ctx, false, true);
+      for (size_t line = 0; line < scale; line++) {
+        write_buffer(ctx, (uint8_t *)run, (column - start) * scale * sizeof(uint16_t));
+      }
+      write_pins(ctx, true, true);
+    }
+  }
+}
+
+// Check whether the transparent drawing should be used, according to the text mode and the estimated cost.
+static bool use_runs(St7735Context *ctx, const FontCharInfo *info, size_t scale) {
+  if (ctx->parent.text_mode == LCD_TextOpaque) {
+    return false;
+  }
+  if (ctx->parent.text_mode == LCD_TextTransparent) {
+    return true;
+  }
+
+  const Font *font = ctx->parent.font;
+  if (LCD_font_bpp(font) > 1) {
+    // Runs can't blend the edges of anti-aliased glyphs.
+    return false;
+  }
+  uint8_t scratch[LCD_GLYPH_ROW_MAX_BYTES];
+  size_t runs = 0, pixels = 0;
+  for (size_t row = 0; row < font->height; row++) {
+    const uint8_t *bitmap = LCD_font_glyph_row(font, info, row, scratch);
+    bool previous         = false;
+    for (size_t column = 0; bitmap != NULL && column < info->width; column++) {
+      bool set = glyph_pixel(bitmap, column);
+      runs += (size_t)(set && !previous);
+      pixels += (size_t)set;
+      previous = set;
+    }
+  }
+  size_t area = scale * scale * sizeof(uint16_t);
+  return runs * WINDOW_COST + pixels * area < WINDOW_COST + info->width * font->height * area;
 }
 
 Result lcd_st7735_putchar(St7735Context *ctx, LCD_Point origin, char character) {
-  const Font *font                    = ctx->parent.font;
-  const FontCharInfo *char_descriptor = &font->descriptor_table[character - font->startCharacter];
-  uint16_t buffer[char_descriptor->width];
+  profile_begin(ctx, St7735OpPutchar);
+  return profile_end(ctx, St7735OpPutchar, lcd_st7735_putchar_scaled(ctx, origin, character, 1));
+}
+
+// Draw an anti-aliased glyph magnified by `scale`, each pixel is a lookup in the blend ramp of the text colors.
+static void draw_glyph_blended(St7735Context *ctx, LCD_Point origin, const FontCharInfo *info, uint32_t scale) {
+  const Font *font = ctx->parent.font;
+  size_t width     = info->width * scale;
+  uint16_t buffer[width];
+  uint8_t coverage[info->width];
+
+  set_address(ctx, origin.x, origin.y, origin.x + width - 1, origin.y + font->height * scale - 1);
+  write_pins(ctx, false, true);
+  for (size_t row = 0; row < font->height; row++) {
+    if (!LCD_font_glyph_coverage(font, info, row, coverage)) {
+      memset(coverage, 0, sizeof(coverage));
+    }
+    uint16_t *pixel = buffer;
+    for (size_t column = 0; column < info->width; column++) {
+      uint16_t color = ctx->text_ramp[coverage[column]];
+      for (uint32_t i = 0; i < scale; i++) {
+        *pixel++ = color;
+      }
+    }
+    for (uint32_t i = 0; i < scale; i++) {
+      write_buffer(ctx, (uint8_t *)buffer, sizeof(buffer));
+    }
+  }
+  write_pins(ctx, true, true);
+}
+
+// Draw a glyph magnified by `scale`, according to the text mode.
+static void draw_glyph(St7735Context *ctx, LCD_Point origin, const FontCharInfo *char_descriptor, uint32_t scale) {
+  const Font *font = ctx->parent.font;
+  if (use_runs(ctx, char_descriptor, scale)) {
+    putchar_runs(ctx, origin, char_descriptor, scale);
+    return;
+  }
+  if (LCD_font_bpp(font) > 1) {
+    draw_glyph_blended(ctx, origin, char_descriptor, scale);
+    return;
+  }
+
+  size_t width = char_descriptor->width * scale;
+  // Rounded up to a whole byte so the last lookup can be copied in full.
+  uint16_t buffer[width + 7];
+  uint8_t scratch[LCD_GLYPH_ROW_MAX_BYTES];
+  bool blank = false;
 
-  set_address(ctx, origin.x, origin.y, origin.x + char_descriptor->width - 1, origin.y + font->height - 1);
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
-  const uint8_t *char_bitmap = &font->bitmap_table[char_descriptor->position];
+  update_mono_lut(ctx, (uint16_t)ctx->parent.foreground_color, (uint16_t)ctx->parent.background_color);
+
+  set_address(ctx, origin.x, origin.y, origin.x + width - 1, origin.y + font->height * scale - 1);
+  write_pins(ctx, false, true);
   for (int row = 0; row < font->height; row++) {
-    for (int column = 0; column < char_descriptor->width; column++) {
-      uint8_t bit = (uint8_t)(column % 8);
-      char_bitmap += (uint8_t)(bit == 0);
-      buffer[column] =
-          (uint16_t)((char_bitmap[-1] & (0x01 << bit)) ? ctx->parent.foreground_color : ctx->parent.background_color);
+    const uint8_t *bitmap = LCD_font_glyph_row(font, char_descriptor, (size_t)row, scratch);
+    if (bitmap == NULL) {
+      // Blank rows are a background fill, the buffer is kept across consecutive blank rows.
+      for (size_t i = 0; !blank && i < width; i++) {
+        buffer[i] = (uint16_t)ctx->parent.background_color;
+      }
+      blank = true;
+    } else {
+      expand_mono(ctx, bitmap, char_descriptor->width, buffer);
+      // Magnify in place from the end, so no pixel is overwritten before it is replicated.
+      for (size_t i = char_descriptor->width * scale; scale > 1 && i-- > 0;) {
+        buffer[i] = buffer[i / scale];
+      }
+      blank = false;
+    }
+    for (uint32_t i = 0; i < scale; i++) {
+      write_buffer(ctx, (uint8_t *)buffer, width * sizeof(uint16_t));
     }
-    write_buffer(ctx, (uint8_t *)buffer, sizeof(buffer));
   }
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  write_pins(ctx, true, true);
+}
+
+Result lcd_st7735_putchar_scaled(St7735Context *ctx, LCD_Point origin, char character, uint32_t scale) {
+  profile_begin(ctx, St7735OpPutcharScaled);
+  COUNT_API(St7735ApiText);
+  if (scale == 0) {
+    return profile_end(ctx, St7735OpPutcharScaled, (Result){.code = -1});
+  }
+
+  const FontCharInfo *char_descriptor = LCD_font_glyph(ctx->parent.font, (unsigned char)character);
+  if (char_descriptor == NULL) {
+    return profile_end(ctx, St7735OpPutcharScaled, (Result){.code = -1});
+  }
+  if (origin.x + char_descriptor->width * scale > ctx->parent.width ||
+      origin.y + ctx->parent.font->height * scale > ctx->parent.height) {
+    return profile_end(ctx, St7735OpPutcharScaled, (Result){.code = -1});
+  }
+
+  draw_glyph(ctx, origin, char_descriptor, scale);
+  return profile_end(ctx, St7735OpPutcharScaled, (Result){.code = 0});
 }
 
 Result lcd_st7735_puts(St7735Context *ctx, LCD_Point pos, const char *text) {
+  profile_begin(ctx, St7735OpPuts);
+  return profile_end(ctx, St7735OpPuts, lcd_st7735_puts_scaled(ctx, pos, text, 1));
+}
+
+Result lcd_st7735_puts_scaled(St7735Context *ctx, LCD_Point pos, const char *text, uint32_t scale) {
+  profile_begin(ctx, St7735OpPutsScaled);
+  COUNT_API(St7735ApiText);
   size_t count = 0;
 
+  if (scale == 0 || pos.y + ctx->parent.font->height * scale > ctx->parent.height) {
+    return profile_end(ctx, St7735OpPutsScaled, (Result){.code = -1});
+  }
+
   while (*text) {
-    uint32_t width = ctx->parent.font->descriptor_table[*text - ctx->parent.font->startCharacter].width;
+    const FontCharInfo *char_descriptor = LCD_font_glyph(ctx->parent.font, LCD_utf8_next(&text));
+    if (char_descriptor == NULL) {
+      // Characters missing in the font are skipped.
+      continue;
+    }
+
+    uint32_t width = char_descriptor->width * scale;
     if ((pos.x + width) > ctx->parent.width) {
-      return (Result){.code = 0};
+      return profile_end(ctx, St7735OpPutsScaled, (Result){.code = 0});
     }
 
-    lcd_st7735_putchar(ctx, pos, *text);
+    draw_glyph(ctx, pos, char_descriptor, scale);
 
     pos.x = pos.x + width;
 
-    text++;
     count++;
   }
 
-  return (Result){.code = (int32_t)count};  // number of chars printed
+  return profile_end(ctx, St7735OpPutsScaled, (Result){.code = (int32_t)count});  // number of chars printed
 }
 
-Result lcd_st7735_draw_bgr(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *bgr) {
-  set_address(ctx, rectangle.origin.x, rectangle.origin.y, rectangle.origin.x + rectangle.width - 1,
-              rectangle.origin.y + rectangle.height - 1);
+Result lcd_st7735_puts_rotated(St7735Context *ctx, LCD_Point origin, const char *text, LCD_TextDirection direction) {
+  profile_begin(ctx, St7735OpPutsRotated);
+  COUNT_API(St7735ApiText);
+  const Font *font = ctx->parent.font;
+  if (font == NULL || text == NULL) {
+    return profile_end(ctx, St7735OpPutsRotated, (Result){.code = ErrorNullArgs});
+  }
 
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
-  for (int i = 0; i < rectangle.width * rectangle.height * 3; i += 3) {
-    uint16_t color = LCD_rgb24_to_bgr565((uint32_t)(bgr[i] << 16 | bgr[i + 1] << 8 | bgr[i + 2]));
-    write_buffer(ctx, (uint8_t *)&color, 2);
+  size_t width = ctx->parent.width, height = ctx->parent.height;
+  if (origin.x + font->height > width || origin.y >= height) {
+    return profile_end(ctx, St7735OpPutsRotated, (Result){.code = -1});
+  }
+
+  // Length of the characters that fit, the text read upwards starts from the bottom of that length.
+  size_t length = 0;
+  for (const char *next = text; *next;) {
+    size_t glyph_width = LCD_font_glyph_width(font, LCD_utf8_next(&next));
+    if (origin.y + length + glyph_width > height) {
+      break;
+    }
+    length += glyph_width;
+  }
+
+  // The orientation rotated by 90 degrees, in which the glyph rows run along the columns of the current one.
+  LCD_Orientation rotated = (LCD_Orientation)((ctx->parent.orientation + (direction == LCD_TextDown ? 1 : 3)) % 4);
+  uint8_t madctl          = ctx->madctl;
+  write_madctl(ctx, orientation_madctl(rotated) | ST77_MADCTL_RGB);
+  SWAP(ctx->col_offset, ctx->row_offset, size_t);
+
+  int32_t count = 0;
+  for (size_t offset = 0; offset < length;) {
+    const FontCharInfo *char_descriptor = LCD_font_glyph(font, LCD_utf8_next(&text));
+    if (char_descriptor == NULL) {
+      // Characters missing in the font are skipped.
+      continue;
+    }
+
+    // Top left corner of the glyph in the rotated address mode.
+    LCD_Point corner = direction == LCD_TextDown
+                           ? (LCD_Point){.x = origin.y + offset, .y = width - origin.x - font->height}
+                           : (LCD_Point){.x = height - origin.y - length + offset, .y = origin.x};
+    draw_glyph(ctx, corner, char_descriptor, 1);
+
+    offset += char_descriptor->width;
+    count++;
+  }
+
+  SWAP(ctx->col_offset, ctx->row_offset, size_t);
+  write_madctl(ctx, madctl);
+  return profile_end(ctx, St7735OpPutsRotated, (Result){.code = count});
+}
+
+Result lcd_st7735_draw_text_box(St7735Context *ctx, LCD_rectangle box, const char *text, LCD_TextAlign align) {
+  profile_begin(ctx, St7735OpDrawTextBox);
+  COUNT_API(St7735ApiText);
+  const Font *font = ctx->parent.font;
+  if (font == NULL || text == NULL) {
+    return profile_end(ctx, St7735OpDrawTextBox, (Result){.code = ErrorNullArgs});
+  }
+
+  if ((box.origin.x >= ctx->parent.width) || (box.origin.y >= ctx->parent.height) ||
+      (box.origin.x + box.width > ctx->parent.width) || (box.origin.y + box.height > ctx->parent.height) ||
+      box.width == 0 || box.height == 0) {
+    return profile_end(ctx, St7735OpDrawTextBox, (Result){.code = -1});
+  }
+
+  uint16_t line[box.width];
+  uint8_t coverage[UINT8_MAX];
+  LCD_TextLine text_line = {0};
+  const char *next       = text;
+  bool has_line          = false;
+  size_t offset          = 0;
+  int32_t count          = 0;
+
+  set_address(ctx, box.origin.x, box.origin.y, box.origin.x + box.width - 1, box.origin.y + box.height - 1);
+
+  write_pins(ctx, false, true);
+  for (size_t row = 0; row < box.height; row++) {
+    size_t glyph_row = row % font->height;
+    if (glyph_row == 0) {
+      // Lay out the next line only when its first row is reached.
+      next     = next ? LCD_text_wrap(font, next, box.width, &text_line) : NULL;
+      has_line = next != NULL;
+      if (has_line) {
+        // A line wider than the box, i.e. a single glyph, is clipped on the right.
+        offset = text_line.width >= box.width ? 0
+                 : align == LCD_AlignRight    ? box.width - text_line.width
+                 : align == LCD_AlignCenter   ? (box.width - text_line.width) / 2
+                                              : 0;
+        count += (int32_t)text_line.length;
+      }
+    }
+
+    for (size_t x = 0; x < box.width; x++) {
+      line[x] = (uint16_t)ctx->parent.background_color;
+    }
+    const char *character = text_line.text;
+    for (size_t x = offset; has_line && character < text_line.text + text_line.length && x < box.width;) {
+      const FontCharInfo *info = LCD_font_glyph(font, LCD_utf8_next(&character));
+      if (info == NULL) {
+        continue;
+      }
+      if (!LCD_font_glyph_coverage(font, info, glyph_row, coverage)) {
+        x += info->width;
+        continue;
+      }
+      for (size_t column = 0; column < info->width && x < box.width; column++, x++) {
+        if (coverage[column]) {
+          line[x] = ctx->text_ramp[coverage[column]];
+        }
+      }
+    }
+    write_buffer(ctx, (uint8_t *)line, sizeof(line));
+  }
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawTextBox, (Result){.code = count});
+}
+
+Result lcd_st7735_text_field_init(St7735TextField *field, LCD_Point origin, uint32_t scale) {
+  if (field == NULL || scale == 0) {
+    return (Result){.code = ErrorNullArgs};
   }
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
+  field->origin  = origin;
+  field->scale   = scale;
+  field->valid   = false;
+  field->width   = 0;
+  field->height  = 0;
+  field->text[0] = '\0';
   return (Result){.code = 0};
 }
 
-Result lcd_st7735_draw_rgb565(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *rgb) {
+Result lcd_st7735_text_field_update(St7735Context *ctx, St7735TextField *field, const char *text) {
+  profile_begin(ctx, St7735OpTextFieldUpdate);
+  COUNT_API(St7735ApiText);
+  const Font *font = ctx->parent.font;
+  if (field == NULL || text == NULL || font == NULL) {
+    return profile_end(ctx, St7735OpTextFieldUpdate, (Result){.code = ErrorNullArgs});
+  }
+
+  bool redraw_all = !field->valid || field->font != font || field->rgb_background != ctx->rgb_background ||
+                    field->rgb_foreground != ctx->rgb_foreground;
+  LCD_TextMode text_mode = ctx->parent.text_mode;
+  ctx->parent.text_mode  = LCD_TextOpaque;
+
+  // A character is redrawn when it differs from the previous one at the same index or when the previous characters
+  // had a different width and shifted it, which can only happen with proportional fonts.
+  size_t x = field->origin.x, old_x = field->origin.x;
+
+  const char *old_text = redraw_all ? "" : field->text;
+  const char *next     = text;
+  size_t length        = 0;
+  int32_t redrawn      = 0;
+  while (*next) {
+    uint32_t codepoint = LCD_utf8_next(&next);
+    if ((size_t)(next - text) > LCD_ST7735_TEXT_FIELD_LEN) {
+      break;
+    }
+    const FontCharInfo *info = LCD_font_glyph(font, codepoint);
+    size_t width             = info ? info->width * field->scale : 0;
+    if (x + width > ctx->parent.width) {
+      break;
+    }
+    uint32_t old_codepoint = LCD_utf8_next(&old_text);
+    if (info && (old_codepoint != codepoint || old_x != x)) {
+      draw_glyph(ctx, (LCD_Point){.x = x, .y = field->origin.y}, info, field->scale);
+      redrawn++;
+    }
+    old_x += LCD_font_glyph_width(font, old_codepoint) * field->scale;
+    x += width;
+    length = (size_t)(next - text);
+  }
+  ctx->parent.text_mode = text_mode;
+
+  // Clean what is left of the previous text.
+  size_t height = font->height * field->scale;
+  if (field->valid && field->origin.x + field->width > x) {
+    lcd_st7735_fill_rectangle(ctx,
+                              (LCD_rectangle){.origin = {.x = x, .y = field->origin.y},
+                                              .width  = field->origin.x + field->width - x,
+                                              .height = field->height},
+                              ctx->rgb_background);
+  }
+  if (field->valid && field->height > height && x > field->origin.x) {
+    lcd_st7735_fill_rectangle(ctx,
+                              (LCD_rectangle){.origin = {.x = field->origin.x, .y = field->origin.y + height},
+                                              .width  = x - field->origin.x,
+                                              .height = field->height - height},
+                              ctx->rgb_background);
+  }
+
+  memcpy(field->text, text, length);
+  field->text[length]   = '\0';
+  field->width          = x - field->origin.x;
+  field->height         = height;
+  field->font           = font;
+  field->rgb_background = ctx->rgb_background;
+  field->rgb_foreground = ctx->rgb_foreground;
+  field->valid          = true;
+  return profile_end(ctx, St7735OpTextFieldUpdate, (Result){.code = redrawn});
+}
+
+// Convert a row of the image to the controller format and return the buffer to be sent, which is the source itself
+// when no conversion is needed.
+static const uint8_t *image_row(LCD_PixelFormat format, const uint8_t *src, uint16_t *line, size_t width) {
+  switch (format) {
+    case LCD_PixelFormatRgb565:
+      for (size_t x = 0; x < width; x++, src += 2) {
+        line[x] = LCD_rgb565_to_bgr565(src);
+      }
+      return (const uint8_t *)line;
+    case LCD_PixelFormatBgr888:
+      for (size_t x = 0; x < width; x++, src += 3) {
+        line[x] = LCD_rgb24_to_bgr565((uint32_t)(src[0] << 16 | src[1] << 8 | src[2]));
+      }
+      return (const uint8_t *)line;
+    case LCD_PixelFormatNative:
+    default:
+      return src;
+  }
+}
+
+Result lcd_st7735_draw_image(St7735Context *ctx, LCD_Point origin, const LCD_Image *image, LCD_rectangle source) {
+  profile_begin(ctx, St7735OpDrawImage);
+  COUNT_API(St7735ApiImage);
+  if (image == NULL || image->data == NULL) {
+    return profile_end(ctx, St7735OpDrawImage, (Result){.code = ErrorNullArgs});
+  }
+
+  if ((origin.x >= ctx->parent.width) || (origin.y >= ctx->parent.height) ||
+      (origin.x + source.width > ctx->parent.width) || (origin.y + source.height > ctx->parent.height) ||
+      (source.origin.x + source.width > image->width) || (source.origin.y + source.height > image->height)) {
+    return profile_end(ctx, St7735OpDrawImage, (Result){.code = -1});
+  }
+
+  if (source.width == 0 || source.height == 0) {
+    return profile_end(ctx, St7735OpDrawImage, (Result){.code = 0});
+  }
+
+  size_t pixel_size  = LCD_pixel_size(image->format);
+  size_t stride      = LCD_image_stride(image);
+  const uint8_t *src = image->data + source.origin.y * stride + source.origin.x * pixel_size;
+  uint16_t line[image->format == LCD_PixelFormatNative ? 1 : source.width];
+
+  set_address(ctx, origin.x, origin.y, origin.x + source.width - 1, origin.y + source.height - 1);
+
+  write_pins(ctx, false, true);
+  if (image->format == LCD_PixelFormatNative && stride == source.width * sizeof(uint16_t)) {
+    // The rows are contiguous, so the whole region can be sent at once.
+    write_buffer(ctx, src, source.width * source.height * sizeof(uint16_t));
+  } else {
+    for (size_t row = 0; row < source.height; row++, src += stride) {
+      write_buffer(ctx, image_row(image->format, src, line, source.width), source.width * sizeof(uint16_t));
+    }
+  }
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawImage, (Result){.code = 0});
+}
+
+Result lcd_st7735_draw_image_scaled(St7735Context *ctx, LCD_rectangle rectangle, const LCD_Image *image,
+                                    LCD_rectangle source) {
+  profile_begin(ctx, St7735OpDrawImageScaled);
+  COUNT_API(St7735ApiImage);
+  if (image == NULL || image->data == NULL) {
+    return profile_end(ctx, St7735OpDrawImageScaled, (Result){.code = ErrorNullArgs});
+  }
+
+  if ((rectangle.origin.x >= ctx->parent.width) || (rectangle.origin.y >= ctx->parent.height) ||
+      (rectangle.origin.x + rectangle.width > ctx->parent.width) ||
+      (rectangle.origin.y + rectangle.height > ctx->parent.height) ||
+      (source.origin.x + source.width > image->width) || (source.origin.y + source.height > image->height)) {
+    return profile_end(ctx, St7735OpDrawImageScaled, (Result){.code = -1});
+  }
+
+  if (rectangle.width == 0 || rectangle.height == 0 || source.width == 0 || source.height == 0) {
+    return profile_end(ctx, St7735OpDrawImageScaled, (Result){.code = 0});
+  }
+
+  size_t pixel_size = LCD_pixel_size(image->format);
+  size_t stride     = LCD_image_stride(image);
+  uint16_t line[rectangle.width];
+
   set_address(ctx, rectangle.origin.x, rectangle.origin.y, rectangle.origin.x + rectangle.width - 1,
               rectangle.origin.y + rectangle.height - 1);
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
-  for (int i = 0; i < rectangle.width * rectangle.height * 2; i += 2, rgb += 2) {
-    uint16_t color = LCD_rgb565_to_bgr565(rgb);
-    write_buffer(ctx, (uint8_t *)&color, 2);
+
+  write_pins(ctx, false, true);
+  // The source coordinates are stepped with the error accumulation of the Bresenham algorithm, which samples
+  // `floor(x * source / rectangle)` without any division.
+  size_t src_row = 0, row_error = 0, last_row = SIZE_MAX;
+  for (size_t row = 0; row < rectangle.height; row++) {
+    if (src_row != last_row) {
+      const uint8_t *src = image->data + (source.origin.y + src_row) * stride + source.origin.x * pixel_size;
+      size_t src_column  = 0, column_error = 0;
+      for (size_t column = 0; column < rectangle.width; column++) {
+        const uint8_t *pixel = src + src_column * pixel_size;
+        switch (image->format) {
+          case LCD_PixelFormatRgb565:
+            line[column] = LCD_rgb565_to_bgr565(pixel);
+            break;
+          case LCD_PixelFormatBgr888:
+            line[column] = LCD_rgb24_to_bgr565((uint32_t)(pixel[0] << 16 | pixel[1] << 8 | pixel[2]));
+            break;
+          case LCD_PixelFormatNative:
+          default:
+            memcpy(&line[column], pixel, sizeof(uint16_t));
+            break;
+        }
+        for (column_error += source.width; column_error >= rectangle.width; column_error -= rectangle.width) {
+          src_column++;
+        }
+      }
+      last_row = src_row;
+    }
+    write_buffer(ctx, (uint8_t *)line, sizeof(line));
+    for (row_error += source.height; row_error >= rectangle.height; row_error -= rectangle.height) {
+      src_row++;
+    }
   }
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpDrawImageScaled, (Result){.code = 0});
+}
+
+Result lcd_st7735_draw_bgr(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *bgr) {
+  profile_begin(ctx, St7735OpDrawBgr);
+  LCD_Image image = {
+      .data = bgr, .format = LCD_PixelFormatBgr888, .width = rectangle.width, .height = rectangle.height};
+  Result result = lcd_st7735_draw_image(ctx, rectangle.origin, &image,
+                                        (LCD_rectangle){.width = rectangle.width, .height = rectangle.height});
+  return profile_end(ctx, St7735OpDrawBgr, result);
+}
+
+Result lcd_st7735_draw_rgb565(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *rgb) {
+  profile_begin(ctx, St7735OpDrawRgb565);
+  LCD_Image image = {
+      .data = rgb, .format = LCD_PixelFormatRgb565, .width = rectangle.width, .height = rectangle.height};
+  Result result = lcd_st7735_draw_image(ctx, rectangle.origin, &image,
+                                        (LCD_rectangle){.width = rectangle.width, .height = rectangle.height});
+  return profile_end(ctx, St7735OpDrawRgb565, result);
 }
 
 Result lcd_st7735_rgb565_start(St7735Context *ctx, LCD_rectangle rectangle) {
+  profile_begin(ctx, St7735OpRgb565Start);
+  COUNT_API(St7735ApiImage);
   set_address(ctx, rectangle.origin.x, rectangle.origin.y, rectangle.origin.x + rectangle.width - 1,
               rectangle.origin.y + rectangle.height - 1);
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
-  return (Result){.code = 0};
+  write_pins(ctx, false, true);
+  return profile_end(ctx, St7735OpRgb565Start, (Result){.code = 0});
 }
 
 Result lcd_st7735_rgb565_put(St7735Context *ctx, const uint8_t *rgb, size_t size) {
+  profile_begin(ctx, St7735OpRgb565Put);
+  COUNT_API(St7735ApiImage);
   for (int i = 0; i < size; i += 2, rgb += 2) {
     uint16_t color = LCD_rgb565_to_bgr565(rgb);
     write_buffer(ctx, (uint8_t *)&color, 2);
   }
-  return (Result){.code = 0};
+  return profile_end(ctx, St7735OpRgb565Put, (Result){.code = 0});
 }
 
 Result lcd_st7735_rgb565_finish(St7735Context *ctx) {
-  ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, true);
-  return (Result){.code = 0};
+  profile_begin(ctx, St7735OpRgb565Finish);
+  write_pins(ctx, true, true);
+  return profile_end(ctx, St7735OpRgb565Finish, (Result){.code = 0});
 }
 
 Result lcd_st7735_reset(St7735Context *ctx, bool hw) {
+  profile_begin(ctx, St7735OpReset);
   if (hw && ctx->parent.interface->reset) {
     ctx->parent.interface->reset(ctx->parent.interface->handle);
   } else {
     write_command(ctx, ST7735_SWRESET);
     delay(ctx, 120);
   }
-  return (Result){.code = 0};
+  return profile_end(ctx, St7735OpReset, (Result){.code = 0});
+}
+
+Result lcd_st7735_close(St7735Context *ctx) {
+  profile_begin(ctx, St7735OpClose);
+  return profile_end(ctx, St7735OpClose, (Result){.code = 0});
+}
+
+Result lcd_st7735_get_counters(St7735Context *ctx, St7735Counters *counters) {
+  if (ctx == NULL || counters == NULL) {
+    return (Result){.code = ErrorNullArgs};
+  }
+#if LCD_ST7735_COUNTERS
+  *counters = ctx->counters;
+  return (Result){.code = ErrorOk};
+#else
+  memset(counters, 0, sizeof(*counters));
+  return (Result){.code = ErrorOperationFailed};
+#endif
 }
 
-Result lcd_st7735_close(St7735Context *ctx) { return (Result){.code = 0}; }
+Result lcd_st7735_reset_counters(St7735Context *ctx) {
+  if (ctx == NULL) {
+    return (Result){.code = ErrorNullArgs};
+  }
+#if LCD_ST7735_COUNTERS
+  memset(&ctx->counters, 0, sizeof(ctx->counters));
+  ctx->counter_api   = St7735ApiOther;
+  ctx->counter_ramwr = false;
+#endif
+  return (Result){.code = ErrorOk};
+}
 
 void lcd_st7735_set_frame_buffer_resolution(St7735Context *ctx, size_t width, size_t height) {
   size_t w = (width - ctx->parent.width) / 2;
@@ -374,17 +1133,19 @@ Result lcd_st7735_check_frame_buffer_resolution(St7735Context *ctx, size_t *widt
   const uint8_t patterns[4] = {0xA8, 0xCC, 0xE0, 0x90};
   uint8_t result;
 
-  if (ctx == NULL && height == NULL && width == NULL) {
+  if (ctx == NULL || height == NULL || width == NULL) {
     return (Result){.code = ErrorNullArgs};
   }
+  profile_begin(ctx, St7735OpCheckFrameBufferResolution);
 
   if (ctx->parent.interface->spi_read == NULL) {
-    return (Result){.code = ErrorNullCallback};
+    return profile_end(ctx, St7735OpCheckFrameBufferResolution, (Result){.code = ErrorNullCallback});
   }
+  COUNT_API(St7735ApiOther);
 
   for (unsigned iter = 0; iter < attempts; iter++) {
     // Ensure CS line is de-asserted ahead of any commands
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, false);
+    write_pins(ctx, true, false);
 
     // Select 18-bit pixel format. Affects writes only (reads always 18-bit).
     // 18-bit pixel format (as per ST7735 datasheet):
@@ -395,14 +1156,14 @@ Result lcd_st7735_check_frame_buffer_resolution(St7735Context *ctx, size_t *widt
     //
     // Where "R5" is the first bit on the wire, and "--" bits are ignored.
     write_command(ctx, ST7735_COLMOD);
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+    write_pins(ctx, false, true);
     uint8_t value = 0x06;
     write_buffer(ctx, &value, sizeof(value));
 
     // Write 4 lots (possibly lines) of 132 pixels into the frame buffer.
     // Change the value being written every 132 pixels.
     write_command(ctx, ST7735_RAMWR);
-    ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+    write_pins(ctx, false, true);
     for (unsigned l = 0u; l < sizeof(patterns); l++) {
       for (unsigned p = 0u; p < 132; p++) {
         // 18-bit pixel value packed into 24-bit (3 bytes) payload.
@@ -426,13 +1187,13 @@ Result lcd_st7735_check_frame_buffer_resolution(St7735Context *ctx, size_t *widt
       buf[2] = 99 >> 8;
       buf[3] = 99;
       write_command(ctx, ST7735_RASET);
-      ctx->parent.interface->gpio_write(ctx->parent.interface->handle, false, true);
+      write_pins(ctx, false, true);
       write_buffer(ctx, buf, 4);
 
       write_command(ctx, ST7735_RAMRD);
       // Read 1 dummy byte and 3 actual bytes (offset by a dummy clock cycle)
       ctx->parent.interface->spi_read(ctx->parent.interface->handle, buf, 4);
-      ctx->parent.interface->gpio_write(ctx->parent.interface->handle, true, false);
+      write_pins(ctx, true, false);
 
       if (buf[1] == (patterns[l] >> 1) && buf[2] == (patterns[l] >> 1) && buf[3] == (patterns[l] >> 1)) {
         // Value read was that written for that line (shift adjusted for
@@ -450,13 +1211,13 @@ Result lcd_st7735_check_frame_buffer_resolution(St7735Context *ctx, size_t *widt
       // Three out of three agree, 128-high it gladly be
       *width  = 160;
       *height = 128;
-      return (Result){.code = ErrorOk};
+      return profile_end(ctx, St7735OpCheckFrameBufferResolution, (Result){.code = ErrorOk});
     }
     if (result == 0x0e) {
       // Three out of three agree, 132-high it sadly be
       *width  = 162;
       *height = 132;
-      return (Result){.code = ErrorOk};
+      return profile_end(ctx, St7735OpCheckFrameBufferResolution, (Result){.code = ErrorOk});
     }
 
     // Software reset to restore most state to default - particularly CASET
@@ -464,5 +1225,41 @@ Result lcd_st7735_check_frame_buffer_resolution(St7735Context *ctx, size_t *widt
   }
 
   // Ran out of attempts, use default (correct 128-wide)
-  return (Result){.code = ErrorOperationFailed};
+  return profile_end(ctx, St7735OpCheckFrameBufferResolution, (Result){.code = ErrorOperationFailed});
+}
+
+const char *lcd_st7735_op_name(uint32_t op) {
+  static const char *const names[St7735OpCount] = {
+      [St7735OpInit]                       = "init",
+      [St7735OpStartup]                    = "startup",
+      [St7735OpReset]                      = "reset",
+      [St7735OpClean]                      = "clean",
+      [St7735OpDrawPixel]                  = "draw_pixel",
+      [St7735OpDrawVerticalLine]           = "draw_vertical_line",
+      [St7735OpDrawHorizontalLine]         = "draw_horizontal_line",
+      [St7735OpDrawBgr]                    = "draw_bgr",
+      [St7735OpDrawRgb565]                 = "draw_rgb565",
+      [St7735OpDrawImage]                  = "draw_image",
+      [St7735OpDrawImageScaled]            = "draw_image_scaled",
+      [St7735OpRgb565Start]                = "rgb565_start",
+      [St7735OpRgb565Put]                  = "rgb565_put",
+      [St7735OpRgb565Finish]               = "rgb565_finish",
+      [St7735OpFillRectangle]              = "fill_rectangle",
+      [St7735OpRenderRegion]               = "render_region",
+      [St7735OpDrawMono]                   = "draw_mono",
+      [St7735OpDrawMonoTransparent]        = "draw_mono_transparent",
+      [St7735OpFillGradient]               = "fill_gradient",
+      [St7735OpFillPattern]                = "fill_pattern",
+      [St7735OpPutchar]                    = "putchar",
+      [St7735OpPuts]                       = "puts",
+      [St7735OpPutcharScaled]              = "putchar_scaled",
+      [St7735OpPutsScaled]                 = "puts_scaled",
+      [St7735OpPutsRotated]                = "puts_rotated",
+      [St7735OpDrawTextBox]                = "draw_text_box",
+      [St7735OpTextFieldUpdate]            = "text_field_update",
+      [St7735OpSetOrientation]             = "set_orientation",
+      [St7735OpClose]                      = "close",
+      [St7735OpCheckFrameBufferResolution] = "check_frame_buffer_resolution",
+  };
+  return op < St7735OpCount ? names[op] : NULL;
 }
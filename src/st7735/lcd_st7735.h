@@ -14,8 +14,100 @@ extern "C" {
 
 #include "../core/font.h"
 #include "../core/lcd_base.h"
+#include "../core/lcd_pattern.h"
+#include "../core/lcd_text.h"
 #include "lcd_st7735_cmds.h"
 
+#ifndef LCD_ST7735_MONO_LUT_BITS
+// Number of bits expanded per lookup by `lcd_st7735_draw_mono` and the text functions, it must be 1, 2, 4 or 8 so
+// the lookups don't straddle bytes. The table uses (2^bits * bits * 2) bytes of RAM in the context, 8 (4KB) gives the
+// best throughput and 4 (128 bytes) suits devices with little RAM.
+#define LCD_ST7735_MONO_LUT_BITS 8
+#endif
+#if LCD_ST7735_MONO_LUT_BITS < 1 || LCD_ST7735_MONO_LUT_BITS > 8 || (8 % LCD_ST7735_MONO_LUT_BITS) != 0
+#error "LCD_ST7735_MONO_LUT_BITS must be 1, 2, 4 or 8"
+#endif
+
+#ifndef LCD_ST7735_TEXT_FIELD_LEN
+// Maximum number of bytes of UTF-8 text remembered by a text field.
+#define LCD_ST7735_TEXT_FIELD_LEN 16
+#endif
+
+#ifndef LCD_ST7735_COUNTERS
+// Set to 1 to count the work done by the driver in each context, see `lcd_st7735_get_counters`. Without it the
+// counters are not in the context and the driver doesn't touch them.
+#define LCD_ST7735_COUNTERS 0
+#endif
+
+/**
+ * @brief Groups of drawing functions, the pixels written are counted per group.
+ *
+ * Pixels are counted for the function that writes them, e.g. `lcd_st7735_clean` counts as a fill and the gradients
+ * as regions.
+ */
+typedef enum {
+  St7735ApiOther = 0, /*!< Anything else, e.g. `lcd_st7735_check_frame_buffer_resolution`.*/
+  St7735ApiPixel,     /*!< `lcd_st7735_draw_pixel`.*/
+  St7735ApiLine,      /*!< The line functions.*/
+  St7735ApiFill,      /*!< `lcd_st7735_fill_rectangle`.*/
+  St7735ApiRegion,    /*!< `lcd_st7735_render_region`, gradients and patterns.*/
+  St7735ApiMono,      /*!< The 1bpp bitmap functions.*/
+  St7735ApiText,      /*!< The text functions.*/
+  St7735ApiImage,     /*!< The BGR, RGB565 and image functions, including the streaming ones.*/
+  St7735ApiCount,
+} St7735Api;
+
+/**
+ * @brief Operation identifiers passed to the `profile_begin` and `profile_end` callbacks of the interface, one per
+ * function that talks to the display. Functions calling other ones, e.g. `lcd_st7735_clean`, nest their calls.
+ */
+typedef enum {
+  St7735OpInit = 0,
+  St7735OpStartup,
+  St7735OpReset,
+  St7735OpClean,
+  St7735OpDrawPixel,
+  St7735OpDrawVerticalLine,
+  St7735OpDrawHorizontalLine,
+  St7735OpDrawBgr,
+  St7735OpDrawRgb565,
+  St7735OpDrawImage,
+  St7735OpDrawImageScaled,
+  St7735OpRgb565Start,
+  St7735OpRgb565Put,
+  St7735OpRgb565Finish,
+  St7735OpFillRectangle,
+  St7735OpRenderRegion,
+  St7735OpDrawMono,
+  St7735OpDrawMonoTransparent,
+  St7735OpFillGradient,
+  St7735OpFillPattern,
+  St7735OpPutchar,
+  St7735OpPuts,
+  St7735OpPutcharScaled,
+  St7735OpPutsScaled,
+  St7735OpPutsRotated,
+  St7735OpDrawTextBox,
+  St7735OpTextFieldUpdate,
+  St7735OpSetOrientation,
+  St7735OpClose,
+  St7735OpCheckFrameBufferResolution,
+  St7735OpCount,
+} St7735Op;
+
+/**
+ * @brief Work done by the driver since the context was initialized or the counters were reset.
+ */
+typedef struct stSt7735Counters {
+  uint32_t commands;               /*!< Commands sent.*/
+  uint32_t windows;                /*!< Address windows set with CASET and RASET.*/
+  uint32_t spi_writes;             /*!< Calls to `spi_write`.*/
+  uint64_t bytes;                  /*!< Bytes passed to `spi_write`, commands included.*/
+  uint32_t gpio_writes;            /*!< Calls to `gpio_write`.*/
+  uint32_t delay_ms;               /*!< Milliseconds requested from `timer_delay`.*/
+  uint64_t pixels[St7735ApiCount]; /*!< Pixels written to the RAM, per group of functions.*/
+} St7735Counters;
+
 /**
  * @brief Context struct.
  */
@@ -27,8 +119,39 @@ typedef struct stSt7735Context {
   // actual resolution.
   size_t col_offset;
   size_t row_offset;
+  // Expansion table of 1bpp bitmaps and glyphs, rebuilt when they are drawn with different colors.
+  struct {
+    bool valid;
+    uint16_t background;
+    uint16_t foreground;
+    uint16_t pixels[1 << LCD_ST7735_MONO_LUT_BITS][LCD_ST7735_MONO_LUT_BITS];
+  } mono_lut;
+  // Text colors blended by coverage, from the background to the foreground, for anti-aliased fonts.
+  uint16_t text_ramp[LCD_COVERAGE_MAX + 1];
+  // Last value written to MADCTL, so switching the address mode back and forth doesn't resend it.
+  uint8_t madctl;
+#if LCD_ST7735_COUNTERS
+  St7735Counters counters;
+  St7735Api counter_api;  // Group of the function being run.
+  bool counter_ramwr;     // The data written goes to the RAM.
+#endif
 } St7735Context;
 
+/**
+ * @brief Text field state, it remembers what was last drawn so only the characters that changed are redrawn.
+ */
+typedef struct stSt7735TextField {
+  LCD_Point origin;                         /*!< Coordinates of the first character.*/
+  uint32_t scale;                           /*!< Magnification factor of the characters.*/
+  bool valid;                               /*!< False until the first update.*/
+  const Font *font;                         /*!< Font used in the last update.*/
+  uint32_t rgb_background;                  /*!< Background color used in the last update.*/
+  uint32_t rgb_foreground;                  /*!< Foreground color used in the last update.*/
+  size_t width;                             /*!< Width in pixels of the last text drawn.*/
+  size_t height;                            /*!< Height in pixels of the last text drawn.*/
+  char text[LCD_ST7735_TEXT_FIELD_LEN + 1]; /*!< Last text drawn.*/
+} St7735TextField;
+
 /**
  * @brief Initialize the LCD driver interfaces.
  *
@@ -139,6 +262,36 @@ Result lcd_st7735_draw_bgr(St7735Context *ctx, LCD_rectangle rectangle, const ui
  */
 Result lcd_st7735_draw_rgb565(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *rgb);
 
+/**
+ * @brief Draw a region of an image.
+ *
+ * The rows are read straight from the image buffer, so a sprite or a region of a larger canvas can be drawn without
+ * copying it out first. Images in `LCD_PixelFormatNative` format are sent without any conversion.
+ *
+ * @param ctx Handle.
+ * @param origin Coordinates of the display where the top left corner of the region will be drawn.
+ * @param image The source image.
+ * @param source Region of the image to be drawn, in image coordinates.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_draw_image(St7735Context *ctx, LCD_Point origin, const LCD_Image *image, LCD_rectangle source);
+
+/**
+ * @brief Draw a region of an image scaled to fill a rectangle, using nearest neighbour sampling.
+ *
+ * The pixels are replicated or skipped while each row is converted, and a converted row is sent again when the next
+ * display row samples the same image row, so scaling up by an integer factor reads each source pixel only once and
+ * doesn't need a temporary image.
+ *
+ * @param ctx Handle.
+ * @param rectangle Area of the display to be filled.
+ * @param image The source image.
+ * @param source Region of the image to be drawn, in image coordinates.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_draw_image_scaled(St7735Context *ctx, LCD_rectangle rectangle, const LCD_Image *image,
+                                    LCD_rectangle source);
+
 /**
  * @brief Starts the iterative draw session.
  *
@@ -178,52 +331,246 @@ Result lcd_st7735_rgb565_finish(St7735Context *ctx);
 Result lcd_st7735_fill_rectangle(St7735Context *ctx, LCD_rectangle rectangle, uint32_t color);
 
 /**
- * @brief Set the font to be used to print text.
+ * @brief Draw a region whose content is generated row by row by a callback.
+ *
+ * A single window is opened for the whole region and each row is streamed as soon as the callback fills it, so no
+ * frame buffer is needed: the memory used is proportional to the width of the region.
  *
  * @param ctx Handle.
- * @param font Pointer to the font to be used.
+ * @param rectangle Definition of the area to be drawn.
+ * @param line_cb Callback called once per row, from top to bottom, to fill the line buffer.
+ * @param user Pointer passed to `line_cb`.
  * @return Result of the operation.
  */
-static inline Result lcd_st7735_set_font(St7735Context *ctx, const Font *font) {
-  return LCD_set_font(&ctx->parent, font);
-}
+Result lcd_st7735_render_region(St7735Context *ctx, LCD_rectangle rectangle, LCD_LineCallback line_cb, void *user);
+
+/**
+ * @brief Draw a 1 bit per pixel bitmap, such as an icon mask.
+ *
+ * Each row of the bitmap starts at a byte boundary and the least significant bit of each byte is the leftmost pixel,
+ * the same layout used by the fonts. The bits are expanded to pixels several at a time through a lookup table that is
+ * only rebuilt when the colors change. The table is shared with the text functions, so interleaving calls with colors
+ * other than the font colors rebuilds it each time, which costs (2^`LCD_ST7735_MONO_LUT_BITS` *
+ * `LCD_ST7735_MONO_LUT_BITS`) pixel writes, 2048 with the default.
+ *
+ * @param ctx Handle.
+ * @param rectangle Definition of the area used by the bitmap.
+ * @param bits Pointer to the bitmap.
+ * @param stride Number of bytes between the start of two consecutive rows of the bitmap.
+ * @param foreground Color of the bits set in RGB 24 bits format.
+ * @param background Color of the bits cleared in RGB 24 bits format.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_draw_mono(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *bits, size_t stride,
+                            uint32_t foreground, uint32_t background);
+
+/**
+ * @brief Draw only the bits set of a 1 bit per pixel bitmap, leaving the background untouched.
+ *
+ * The bitmap layout is the same as `lcd_st7735_draw_mono`. A window is opened for each horizontal run of bits set, so
+ * sparse bitmaps are cheaper than fragmented ones.
+ *
+ * @param ctx Handle.
+ * @param rectangle Definition of the area used by the bitmap.
+ * @param bits Pointer to the bitmap.
+ * @param stride Number of bytes between the start of two consecutive rows of the bitmap.
+ * @param foreground Color of the bits set in RGB 24 bits format.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_draw_mono_transparent(St7735Context *ctx, LCD_rectangle rectangle, const uint8_t *bits,
+                                        size_t stride, uint32_t foreground);
+
+/**
+ * @brief Fill a rectangle with a color gradient.
+ *
+ * The gradient is computed incrementally one row at a time, so it doesn't need an image buffer.
+ *
+ * @param ctx Handle.
+ * @param rectangle Definition of the rectangle area.
+ * @param type Direction of the gradient.
+ * @param from Start color in RGB 24 bits format.
+ * @param to End color in RGB 24 bits format.
+ * @param dither If true an ordered dither is applied to hide the banding caused by the 16 bits color depth.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_fill_gradient(St7735Context *ctx, LCD_rectangle rectangle, LCD_GradientType type, uint32_t from,
+                                uint32_t to, bool dither);
+
+/**
+ * @brief Fill a rectangle with a two colors pattern.
+ *
+ * @param ctx Handle.
+ * @param rectangle Definition of the rectangle area.
+ * @param type The pattern type.
+ * @param size Size of the cells or stripes in pixels.
+ * @param color_a First color in RGB 24 bits format.
+ * @param color_b Second color in RGB 24 bits format.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_fill_pattern(St7735Context *ctx, LCD_rectangle rectangle, LCD_PatternType type, size_t size,
+                               uint32_t color_a, uint32_t color_b);
 
 /**
  * @brief Set the background and foreground colors for text printing.
  *
+ * The blend ramp used by anti-aliased fonts is computed here, so drawing them costs a table lookup per pixel. The
+ * lookup table of 1 bit per pixel fonts is shared with `lcd_st7735_draw_mono` and rebuilt by the next text drawn after
+ * it is used with other colors.
+ *
  * @param ctx Handle.
  * @param background_color  Color in RGB 24 bits format.
  * @param foreground_color  Color in RGB 24 bits format.
  * @return Result of the operation.
  */
-static inline Result lcd_st7735_set_font_colors(St7735Context *ctx, uint32_t background_color,
-                                                uint32_t foreground_color) {
-  ctx->rgb_background = background_color;
-  ctx->rgb_foreground = foreground_color;
-  return LCD_set_font_colors(&ctx->parent, LCD_rgb24_to_bgr565(background_color),
-                             LCD_rgb24_to_bgr565(foreground_color));
+Result lcd_st7735_set_font_colors(St7735Context *ctx, uint32_t background_color, uint32_t foreground_color);
+
+/**
+ * @brief Set the font to be used to print text, the colors are reset to black on white.
+ *
+ * @param ctx Handle.
+ * @param font Pointer to the font to be used.
+ * @return Result of the operation.
+ */
+static inline Result lcd_st7735_set_font(St7735Context *ctx, const Font *font) {
+  Result res = LCD_set_font(&ctx->parent, font);
+  lcd_st7735_set_font_colors(ctx, 0xFFFFFF, 0x000000);
+  return res;
 }
 
 /**
- * @brief Draw an ASCII character.
+ * @brief Set how the background of the characters is painted.
+ *
+ * In `LCD_TextTransparent` mode each row of a glyph is decomposed into runs of foreground pixels and a window is
+ * opened per run, so text can be drawn over images. `LCD_TextAuto` estimates the bus cost of the runs and paints the
+ * opaque cell instead when that is cheaper, it is meant for text over a plain area of the background color.
+ * Anti-aliased fonts are drawn without blending in the transparent mode and always opaque in the auto mode.
  *
  * @param ctx Handle.
- * @param origin The origin coordinate of the character.
- * @param character The ASCII character to be printed.
+ * @param mode The text mode, the default is `LCD_TextOpaque`.
  * @return Result of the operation.
  */
+static inline Result lcd_st7735_set_text_mode(St7735Context *ctx, LCD_TextMode mode) {
+  return LCD_set_text_mode(&ctx->parent, mode);
+}
+
+/**
+ * @brief Draw a character.
+ *
+ * @param ctx Handle.
+ * @param origin The origin coordinate of the character.
+ * @param character The ASCII or Latin-1 character to be printed.
+ * @return Result of the operation, -1 if the font doesn't have the character.
+ */
 Result lcd_st7735_putchar(St7735Context *ctx, LCD_Point origin, char character);
 
 /**
- * @brief Draw a string using ASCII characters.
+ * @brief Draw an UTF-8 string, characters missing in the font are skipped.
  *
  * @param ctx Handle.
  * @param origin The origin coordinate of the first character.
- * @param text Pointer to a null terminated string.
+ * @param text Pointer to a null terminated UTF-8 string.
  * @return Result of the operation.
  */
 Result lcd_st7735_puts(St7735Context *ctx, LCD_Point origin, const char *text);
 
+/**
+ * @brief Draw a character magnified by an integer factor.
+ *
+ * Each glyph bit is replicated `scale` times into the row buffer, which is then sent `scale` times within a single
+ * window, so large characters don't need extra font tables.
+ *
+ * @param ctx Handle.
+ * @param origin The origin coordinate of the character.
+ * @param character The ASCII or Latin-1 character to be printed.
+ * @param scale Magnification factor, 1 is the same as `lcd_st7735_putchar`.
+ * @return Result of the operation, -1 if the magnified character doesn't fit the display.
+ */
+Result lcd_st7735_putchar_scaled(St7735Context *ctx, LCD_Point origin, char character, uint32_t scale);
+
+/**
+ * @brief Draw an UTF-8 string magnified by an integer factor.
+ *
+ * @param ctx Handle.
+ * @param origin The origin coordinate of the first character.
+ * @param text Pointer to a null terminated UTF-8 string.
+ * @param scale Magnification factor, 1 is the same as `lcd_st7735_puts`.
+ * @return Result of the operation, on success the code is the number of characters printed, -1 if the magnified text
+ * doesn't fit below `origin`.
+ */
+Result lcd_st7735_puts_scaled(St7735Context *ctx, LCD_Point origin, const char *text, uint32_t scale);
+
+/**
+ * @brief Draw an UTF-8 string rotated 90 degrees, for vertical labels.
+ *
+ * The address mode is switched to the orientation rotated by 90 degrees, so each glyph is streamed in a single window
+ * row by row as horizontal text is, and switched back at the end. The glyphs are drawn according to the text mode.
+ *
+ * @param ctx Handle.
+ * @param origin The top left corner of the area covered by the text, which is as wide as the font height.
+ * @param text Pointer to a null terminated UTF-8 string.
+ * @param direction Direction in which the text is read.
+ * @return Result of the operation, on success the code is the number of characters printed, the characters that
+ * don't fit above the bottom of the display are not printed.
+ */
+Result lcd_st7735_puts_rotated(St7735Context *ctx, LCD_Point origin, const char *text, LCD_TextDirection direction);
+
+/**
+ * @brief Measure a string using the current font, without drawing it.
+ *
+ * @param ctx Handle.
+ * @param text Pointer to a null terminated UTF-8 string.
+ * @param[out] width Pointer to receive the width in pixels.
+ * @param[out] height Pointer to receive the height in pixels.
+ * @return Result of the operation.
+ */
+static inline Result lcd_st7735_measure_text(St7735Context *ctx, const char *text, size_t *width, size_t *height) {
+  if (ctx->parent.font == NULL || text == NULL) {
+    return (Result){.code = ErrorNullArgs};
+  }
+  *width  = LCD_measure_text(ctx->parent.font, text, SIZE_MAX);
+  *height = ctx->parent.font->height;
+  return (Result){.code = 0};
+}
+
+/**
+ * @brief Draw a text wrapped and aligned inside a box, using the current font and colors.
+ *
+ * The text is broken in lines with `LCD_text_wrap` and the whole box is streamed in a single window, painting the
+ * area not covered by the text with the background color. Lines that don't fit in the box are clipped.
+ *
+ * @param ctx Handle.
+ * @param box Definition of the box area.
+ * @param text Pointer to a null terminated UTF-8 string, new line characters force a line break.
+ * @param align Horizontal alignment of the lines.
+ * @return Result of the operation, on success the code is the number of characters in the lines drawn.
+ */
+Result lcd_st7735_draw_text_box(St7735Context *ctx, LCD_rectangle box, const char *text, LCD_TextAlign align);
+
+/**
+ * @brief Initialize a text field.
+ *
+ * @param field The text field.
+ * @param origin The origin coordinate of the first character.
+ * @param scale Magnification factor of the characters, see `lcd_st7735_puts_scaled`.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_text_field_init(St7735TextField *field, LCD_Point origin, uint32_t scale);
+
+/**
+ * @brief Draw a new text in a text field, using the current font and colors.
+ *
+ * Only the characters whose glyph or position changed since the last update are redrawn, so a counter that ticks by
+ * one redraws a single character. The area left uncovered when the text gets narrower is painted with the background
+ * color. The whole text is redrawn when the font or the colors change. The characters are always drawn opaque and up
+ * to `LCD_ST7735_TEXT_FIELD_LEN` bytes of text are drawn.
+ *
+ * @param ctx Handle.
+ * @param field The text field.
+ * @param text Pointer to a null terminated UTF-8 string.
+ * @return Result of the operation, on success the code is the number of characters redrawn.
+ */
+Result lcd_st7735_text_field_update(St7735Context *ctx, St7735TextField *field, const char *text);
+
 /**
  * @brief Set the display orientation
  *
@@ -262,6 +609,31 @@ void lcd_st7735_set_frame_buffer_resolution(St7735Context *ctx, size_t width, si
  */
 Result lcd_st7735_check_frame_buffer_resolution(St7735Context *lcd, size_t *width, size_t *height);
 
+/**
+ * @brief Take a snapshot of the counters.
+ *
+ * @param ctx Handle.
+ * @param[out] counters The counters, all zero when the driver is built without `LCD_ST7735_COUNTERS`.
+ * @return Result of the operation, `ErrorOperationFailed` when the driver is built without `LCD_ST7735_COUNTERS`.
+ */
+Result lcd_st7735_get_counters(St7735Context *ctx, St7735Counters *counters);
+
+/**
+ * @brief Set the counters back to zero.
+ *
+ * @param ctx Handle.
+ * @return Result of the operation.
+ */
+Result lcd_st7735_reset_counters(St7735Context *ctx);
+
+/**
+ * @brief Name of an operation, e.g. "fill_rectangle" for `St7735OpFillRectangle`.
+ *
+ * @param op The operation identifier, see `St7735Op`.
+ * @return The name, NULL if `op` is not an operation.
+ */
+const char *lcd_st7735_op_name(uint32_t op);
+
 #ifdef __cplusplus
 }
 #endif
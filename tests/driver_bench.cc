@@ -0,0 +1,210 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Cost of the drawing functions, against an interface that only counts the calls and against the simulator.
+//
+// Besides the time, each benchmark reports the interface callbacks and the bytes written per iteration, and the time
+// per pixel drawn.
+//
+// Usage: st7735_driver_bench [--benchmark_filter=regex]
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "../src/core/lucida_console_10pt.h"
+#include "../src/core/lucida_console_12pt.h"
+#include "../src/core/m3x6_16pt.h"
+#include "../src/core/m5x7_16pt.h"
+#include "../src/st7735/lcd_st7735.h"
+#include <simulator/st7735/controller.hh>
+
+constexpr size_t DisplayWidth  = 160;
+constexpr size_t DisplayHeight = 128;
+
+// Display that ignores everything, to measure the driver alone.
+struct NullDisplay {
+  void spi_write(std::span<const uint8_t> data) { benchmark::DoNotOptimize(data.data()); }
+  void dc_pin(Simulator::PinLevel level) {}
+  void cs_pin(Simulator::PinLevel level) {}
+};
+
+using SimulatorDisplay = Simulator::St7735<DisplayWidth, DisplayHeight>;
+
+// Interface counting the callbacks and the bytes written before passing them to the display.
+template <typename Display>
+struct CountingInterface {
+  Display display;
+  size_t callbacks = 0;
+  size_t bytes     = 0;
+
+  static uint32_t spi_write(void *handle, uint8_t *data, size_t len) {
+    CountingInterface *self = static_cast<CountingInterface *>(handle);
+    self->callbacks++;
+    self->bytes += len;
+    self->display.spi_write({data, len});
+    return len;
+  }
+
+  static uint32_t gpio_write(void *handle, bool cs, bool dc) {
+    CountingInterface *self = static_cast<CountingInterface *>(handle);
+    self->callbacks++;
+    self->display.dc_pin(dc ? Simulator::PinLevel::High : Simulator::PinLevel::Low);
+    self->display.cs_pin(cs ? Simulator::PinLevel::High : Simulator::PinLevel::Low);
+    return 0;
+  }
+
+  static uint32_t reset(void *handle) { return 0; }
+  static void set_pwm(void *handle, uint8_t pwm) {}
+  static void sleep_ms(void *handle, uint32_t ms) {}
+};
+
+// Driver initialized on a counting interface, the counters start after the startup.
+template <typename Display>
+struct Driver {
+  std::unique_ptr<CountingInterface<Display>> bus = std::make_unique<CountingInterface<Display>>();
+  LCD_Interface interface;
+  St7735Context ctx;
+
+  Driver() {
+    interface = {
+        .handle            = bus.get(),
+        .spi_write         = CountingInterface<Display>::spi_write,
+        .spi_read          = NULL,
+        .gpio_write        = CountingInterface<Display>::gpio_write,
+        .reset             = CountingInterface<Display>::reset,
+        .set_backlight_pwm = CountingInterface<Display>::set_pwm,
+        .timer_delay       = CountingInterface<Display>::sleep_ms,
+    };
+    lcd_st7735_init(&ctx, &interface);
+    lcd_st7735_startup(&ctx);
+    bus->callbacks = 0;
+    bus->bytes     = 0;
+  }
+
+  // Run `draw` for each iteration and report the counters, `pixels` being the pixels drawn per iteration.
+  template <typename Draw>
+  void run(benchmark::State &state, size_t pixels, Draw draw) {
+    auto start = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+      draw(&ctx);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    auto per_iteration      = benchmark::Counter::kAvgIterations;
+    state.counters["calls"] = benchmark::Counter(static_cast<double>(bus->callbacks), per_iteration);
+    state.counters["bytes"] = benchmark::Counter(static_cast<double>(bus->bytes), per_iteration);
+    state.counters["ns/px"] = elapsed.count() / static_cast<double>(state.iterations() * pixels);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pixels));
+  }
+};
+
+// Square of `state.range(0)` pixels, up to 120.
+static LCD_rectangle square(const benchmark::State &state) {
+  size_t size = static_cast<size_t>(state.range(0));
+  return LCD_rectangle{.origin = {.x = 3, .y = 5}, .width = size, .height = size};
+}
+
+template <typename Display>
+static void bench_fill_rectangle(benchmark::State &state) {
+  LCD_rectangle rectangle = square(state);
+  Driver<Display>().run(state, rectangle.width * rectangle.height,
+                        [&](St7735Context *ctx) { lcd_st7735_fill_rectangle(ctx, rectangle, 0x3060F0); });
+}
+
+template <typename Display>
+static void bench_clean(benchmark::State &state) {
+  Driver<Display>().run(state, DisplayWidth * DisplayHeight, [](St7735Context *ctx) { lcd_st7735_clean(ctx); });
+}
+
+template <typename Display>
+static void bench_horizontal_line(benchmark::State &state) {
+  LCD_Line line{.origin = {.x = 0, .y = 20}, .length = DisplayWidth};
+  Driver<Display>().run(state, line.length,
+                        [&](St7735Context *ctx) { lcd_st7735_draw_horizontal_line(ctx, line, 0x00FF00); });
+}
+
+template <typename Display>
+static void bench_vertical_line(benchmark::State &state) {
+  LCD_Line line{.origin = {.x = 20, .y = 0}, .length = DisplayHeight};
+  Driver<Display>().run(state, line.length,
+                        [&](St7735Context *ctx) { lcd_st7735_draw_vertical_line(ctx, line, 0x00FF00); });
+}
+
+static const Font *const fonts[] = {&lucidaConsole_10ptFont, &lucidaConsole_12ptFont, &m3x6_16ptFont, &m5x7_16ptFont};
+static const char *const font_names[] = {"lucida_console_10pt", "lucida_console_12pt", "m3x6_16pt", "m5x7_16pt"};
+
+template <typename Display>
+static void bench_putchar(benchmark::State &state) {
+  const Font *font = fonts[state.range(0)];
+  state.SetLabel(font_names[state.range(0)]);
+  Driver<Display> driver;
+  lcd_st7735_set_font(&driver.ctx, font);
+  driver.run(state, LCD_font_glyph_width(font, 'A') * font->height,
+             [](St7735Context *ctx) { lcd_st7735_putchar(ctx, LCD_Point{.x = 10, .y = 10}, 'A'); });
+}
+
+template <typename Display>
+static void bench_puts(benchmark::State &state) {
+  static const char text[] = "The quick brown fox";
+  const Font *font         = fonts[state.range(0)];
+  state.SetLabel(font_names[state.range(0)]);
+  Driver<Display> driver;
+  lcd_st7735_set_font(&driver.ctx, font);
+  driver.run(state, LCD_measure_text(font, text, sizeof(text)) * font->height,
+             [](St7735Context *ctx) { lcd_st7735_puts(ctx, LCD_Point{.x = 0, .y = 10}, text); });
+}
+
+template <typename Display>
+static void bench_draw_bgr(benchmark::State &state) {
+  LCD_rectangle rectangle = square(state);
+  std::vector<uint8_t> bgr(rectangle.width * rectangle.height * 3, 0x5A);
+  Driver<Display>().run(state, rectangle.width * rectangle.height,
+                        [&](St7735Context *ctx) { lcd_st7735_draw_bgr(ctx, rectangle, bgr.data()); });
+}
+
+template <typename Display>
+static void bench_draw_rgb565(benchmark::State &state) {
+  LCD_rectangle rectangle = square(state);
+  std::vector<uint8_t> rgb(rectangle.width * rectangle.height * 2, 0x5A);
+  Driver<Display>().run(state, rectangle.width * rectangle.height,
+                        [&](St7735Context *ctx) { lcd_st7735_draw_rgb565(ctx, rectangle, rgb.data()); });
+}
+
+// The streaming API fed one row at a time.
+template <typename Display>
+static void bench_rgb565_stream(benchmark::State &state) {
+  LCD_rectangle rectangle = square(state);
+  std::vector<uint8_t> row(rectangle.width * 2, 0x5A);
+  Driver<Display>().run(state, rectangle.width * rectangle.height, [&](St7735Context *ctx) {
+    lcd_st7735_rgb565_start(ctx, rectangle);
+    for (size_t y = 0; y < rectangle.height; y++) {
+      lcd_st7735_rgb565_put(ctx, row.data(), row.size());
+    }
+    lcd_st7735_rgb565_finish(ctx);
+  });
+}
+
+// Register `bench_<name>` against both displays, `...` being the arguments, e.g. `->Arg(8)`.
+#define DRIVER_BENCHMARK(name, ...)                                                   \
+  BENCHMARK_TEMPLATE(bench_##name, NullDisplay)->Name(#name "/null") __VA_ARGS__; \
+  BENCHMARK_TEMPLATE(bench_##name, SimulatorDisplay)->Name(#name "/simulator") __VA_ARGS__
+
+#define SQUARES ->Arg(8)->Arg(32)->Arg(120)
+#define FONTS ->DenseRange(0, std::size(fonts) - 1)
+
+DRIVER_BENCHMARK(fill_rectangle, SQUARES);
+DRIVER_BENCHMARK(clean);
+DRIVER_BENCHMARK(horizontal_line);
+DRIVER_BENCHMARK(vertical_line);
+DRIVER_BENCHMARK(putchar, FONTS);
+DRIVER_BENCHMARK(puts, FONTS);
+DRIVER_BENCHMARK(draw_bgr, SQUARES);
+DRIVER_BENCHMARK(draw_rgb565, SQUARES);
+DRIVER_BENCHMARK(rgb565_stream, SQUARES);
+
+BENCHMARK_MAIN();
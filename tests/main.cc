@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "../src/st7735/lcd_st7735.h"
 #define STB_IMAGE_IMPLEMENTATION
@@ -23,44 +27,41 @@ void log_hex(std::ostream &stream, const uint8_t *data, size_t len) {
 
 struct MockInterfaceFile {
   std::string filename_;
+  std::ofstream file_;
 
   MockInterfaceFile() {
     char buffer[1024];
     filename_ = std::string(std::tmpnam(buffer));
+    file_.open(filename_, std::ios::app);
   };
 
   static uint32_t spi_write(void *handle, uint8_t *data, size_t len) {
     MockInterfaceFile *self = (MockInterfaceFile *)handle;
-    std::ofstream file(self->filename_, std::ios::app);
-    file << std::format("{}: ", __func__);
-    log_hex(file, data, len);
+    self->file_ << std::format("{}: ", __func__);
+    log_hex(self->file_, data, len);
     return len;
   }
 
   static uint32_t gpio_write(void *handle, bool cs, bool dc) {
     MockInterfaceFile *self = (MockInterfaceFile *)handle;
-    std::ofstream file(self->filename_, std::ios::app);
-    file << std::format("{}: cs={}, dc={}", __func__, cs, dc) << std::endl;
+    self->file_ << std::format("{}: cs={}, dc={}", __func__, cs, dc) << std::endl;
     return 0;
   }
 
   static uint32_t reset(void *handle) {
     MockInterfaceFile *self = (MockInterfaceFile *)handle;
-    std::ofstream file(self->filename_, std::ios::app);
-    file << std::format("{}", __func__) << std::endl;
+    self->file_ << std::format("{}", __func__) << std::endl;
     return 0;
   }
 
   static void set_pwm(void *handle, uint8_t pwm) {
     MockInterfaceFile *self = (MockInterfaceFile *)handle;
-    std::ofstream file(self->filename_, std::ios::app);
-    file << std::format("{}: {}", __func__, pwm) << std::endl;
+    self->file_ << std::format("{}: {}", __func__, pwm) << std::endl;
   }
 
   static void sleep_ms(void *handle, uint32_t ms) {
     MockInterfaceFile *self = (MockInterfaceFile *)handle;
-    std::ofstream file(self->filename_, std::ios::app);
-    file << std::format("{}: {}", __func__, ms) << std::endl;
+    self->file_ << std::format("{}: {}", __func__, ms) << std::endl;
   }
 };
 
@@ -140,12 +141,19 @@ TEST_F(st7735Test, startup) {
 #include <simulator/st7735/controller.hh>
 struct MockInterfaceSimulator {
   Simulator::St7735<DisplayWidth, DisplayHeight> simulator;
+  // When not 0, the writes are split in chunks of 1 to `max_chunk` bytes, like a streaming driver would send them.
+  size_t max_chunk = 0;
 
   MockInterfaceSimulator() {};
 
   static uint32_t spi_write(void *handle, uint8_t *data, size_t len) {
     MockInterfaceSimulator *self = (MockInterfaceSimulator *)handle;
-    self->simulator.spi_write(data, len);
+    std::span<const uint8_t> buffer(data, len);
+    for (size_t chunk = 1; self->max_chunk && buffer.size() > chunk; chunk = chunk % self->max_chunk + 1) {
+      self->simulator.spi_write(buffer.first(chunk));
+      buffer = buffer.subspan(chunk);
+    }
+    self->simulator.spi_write(buffer);
     return len;
   }
 
@@ -334,6 +342,1130 @@ TEST_F(st7735SimTest, font_m5x7_16pt) {
   compare_img(filename, GET_GOLDEN_FILE());
 }
 
+TEST_F(st7735SimTest, render_region) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  // Procedural XOR texture, generated one row at a time.
+  auto xor_texture = [](void *user, size_t row, uint16_t *line, size_t width) {
+    size_t *calls = static_cast<size_t *>(user);
+    for (size_t x = 0; x < width; ++x) {
+      uint8_t v = static_cast<uint8_t>((x ^ row) << 2);
+      line[x]   = LCD_rgb24_to_bgr565(static_cast<uint32_t>(v << 16 | (255 - v) << 8 | (v ^ 0x55)));
+    }
+    (*calls)++;
+  };
+
+  size_t calls = 0;
+  LCD_rectangle rec{.origin = {.x = 16, .y = 8}, .width = 128, .height = 112};
+  res = lcd_st7735_render_region(&ctx_, rec, xor_texture, &calls);
+  EXPECT_EQ(res.code, 0);
+  EXPECT_EQ(calls, rec.height);
+
+  rec.width = DisplayWidth;
+  res       = lcd_st7735_render_region(&ctx_, rec, xor_texture, &calls);
+  EXPECT_EQ(res.code, -1);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, fill_gradient) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  const size_t w = DisplayWidth / 2, h = DisplayHeight / 3;
+  auto gradient  = [&](LCD_Point origin, LCD_GradientType type, uint32_t from, uint32_t to, bool dither) {
+    res = lcd_st7735_fill_gradient(&ctx_, LCD_rectangle{.origin = origin, .width = w, .height = h}, type, from, to,
+                                    dither);
+    EXPECT_EQ(res.code, 0);
+  };
+
+  gradient({.x = 0, .y = 0}, LCD_GradientHorizontal, 0x000000, 0xffffff, false);
+  gradient({.x = w, .y = 0}, LCD_GradientHorizontal, 0x000000, 0xffffff, true);
+  gradient({.x = 0, .y = h}, LCD_GradientVertical, 0xff0000, 0x0000ff, false);
+  gradient({.x = w, .y = h}, LCD_GradientDiagonal, 0x00ff00, 0xff00ff, true);
+  gradient({.x = 0, .y = 2 * h}, LCD_GradientRadial, 0xffff00, 0x000080, false);
+
+  res = lcd_st7735_fill_pattern(&ctx_, LCD_rectangle{.origin = {.x = w, .y = 2 * h}, .width = w / 2, .height = h},
+                                LCD_PatternChecker, 6, 0x202020, 0xe0e0e0);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_fill_pattern(&ctx_,
+                                LCD_rectangle{.origin = {.x = w + w / 2, .y = 2 * h}, .width = w / 2, .height = h / 2},
+                                LCD_PatternHorizontalStripes, 3, 0xff0000, 0xffffff);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_fill_pattern(
+      &ctx_, LCD_rectangle{.origin = {.x = w + w / 2, .y = 2 * h + h / 2}, .width = w / 2, .height = h - h / 2},
+      LCD_PatternVerticalStripes, 4, 0x0000ff, 0xffffff);
+  EXPECT_EQ(res.code, 0);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST(PatternTest, gradient_init) {
+  // Decreasing channels step down and an empty area is the start color.
+  LCD_Gradient gradient;
+  LCD_gradient_init(&gradient, LCD_GradientHorizontal, 0xff8000, 0x000000, 256, 1, false);
+  EXPECT_EQ(gradient.step[0], -65536);
+  EXPECT_EQ(gradient.step[1], -128 * 65536 / 255);
+  uint16_t line[256];
+  LCD_gradient_line(&gradient, 0, line, 256);
+  EXPECT_EQ(line[0], LCD_rgb24_to_bgr565(0xff8000));
+  EXPECT_EQ(line[255], 0);
+
+  LCD_gradient_init(&gradient, LCD_GradientDiagonal, 0xff8000, 0x000000, 0, 0, false);
+  EXPECT_EQ(gradient.step[0], 0);
+  EXPECT_EQ(gradient.step[1], 0);
+}
+
+TEST_F(st7735SimTest, draw_mono) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  // 13x12 pixels icon, two bytes per row, the leftmost pixel in the least significant bit.
+  constexpr size_t icon_w = 13, icon_h = 12, stride = 2;
+  const uint8_t icon[icon_h * stride] = {
+      0xf0, 0x01, 0x0c, 0x06, 0x02, 0x08, 0x62, 0x08, 0x61, 0x10, 0x01, 0x10,
+      0x01, 0x10, 0x09, 0x12, 0x12, 0x09, 0xe2, 0x08, 0x0c, 0x06, 0xf0, 0x01,
+  };
+
+  uint32_t fg = 0x0000ff, bg = 0xffff00;
+  for (uint32_t y = 0; y + icon_h <= DisplayHeight / 2; y += icon_h) {
+    for (uint32_t x = 0; x + icon_w <= DisplayWidth; x += icon_w) {
+      res = lcd_st7735_draw_mono(&ctx_, LCD_rectangle{.origin = {.x = x, .y = y}, .width = icon_w, .height = icon_h},
+                                 icon, stride, fg, bg);
+      EXPECT_EQ(res.code, 0);
+    }
+    SWAP(fg, bg, uint32_t);
+  }
+
+  LCD_rectangle bottom{.origin = {.x = 0, .y = DisplayHeight / 2}, .width = DisplayWidth, .height = DisplayHeight / 2};
+  res = lcd_st7735_fill_gradient(&ctx_, bottom, LCD_GradientHorizontal, 0xff0000, 0x00ff00, false);
+  EXPECT_EQ(res.code, 0);
+  for (uint32_t x = 0; x + icon_w <= DisplayWidth; x += icon_w + 2) {
+    res = lcd_st7735_draw_mono_transparent(
+        &ctx_, LCD_rectangle{.origin = {.x = x, .y = DisplayHeight / 2 + 20}, .width = icon_w, .height = icon_h}, icon,
+        stride, 0x000000);
+    EXPECT_EQ(res.code, 0);
+  }
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_image) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  // Sprite sheet with 4x2 tiles of 16x16 pixels and 8 bytes of padding at the end of each row.
+  constexpr uint32_t tile = 16;
+  constexpr size_t sheet_w = 4 * tile, sheet_h = 2 * tile, stride = sheet_w * 2 + 8;
+  std::vector<uint8_t> rgb565(stride * sheet_h);
+  std::vector<uint8_t> bgr(sheet_w * sheet_h * 3);
+  std::vector<uint16_t> native(sheet_w * sheet_h);
+  for (size_t y = 0; y < sheet_h; ++y) {
+    for (size_t x = 0; x < sheet_w; ++x) {
+      uint8_t r      = static_cast<uint8_t>((x / tile) * 80);
+      uint8_t g      = static_cast<uint8_t>((y / tile) * 255);
+      uint8_t b      = static_cast<uint8_t>(((x % tile) ^ (y % tile)) * 16);
+      uint16_t color = static_cast<uint16_t>((r >> 3) << 11 | (g >> 2) << 5 | b >> 3);
+
+      rgb565[y * stride + x * 2]     = static_cast<uint8_t>(color);
+      rgb565[y * stride + x * 2 + 1] = static_cast<uint8_t>(color >> 8);
+      bgr[(y * sheet_w + x) * 3]     = r;
+      bgr[(y * sheet_w + x) * 3 + 1] = g;
+      bgr[(y * sheet_w + x) * 3 + 2] = b;
+      native[y * sheet_w + x]        = LCD_rgb24_to_bgr565(static_cast<uint32_t>(r << 16 | g << 8 | b));
+    }
+  }
+
+  LCD_Image sheet{.data = rgb565.data(), .format = LCD_PixelFormatRgb565, .width = sheet_w, .height = sheet_h,
+                  .stride = stride};
+  for (uint32_t i = 0; i < 8; ++i) {
+    LCD_rectangle src{.origin = {.x = (i % 4) * tile, .y = (i / 4) * tile}, .width = tile, .height = tile};
+    res = lcd_st7735_draw_image(&ctx_, LCD_Point{.x = i * (tile + 2), .y = 0}, &sheet, src);
+    EXPECT_EQ(res.code, 0);
+  }
+
+  // A region crossing tiles, from each pixel format.
+  LCD_rectangle src{.origin = {.x = 8, .y = 8}, .width = 40, .height = 20};
+  res = lcd_st7735_draw_image(&ctx_, LCD_Point{.x = 0, .y = 40}, &sheet, src);
+  EXPECT_EQ(res.code, 0);
+  LCD_Image sheet_bgr{.data = bgr.data(), .format = LCD_PixelFormatBgr888, .width = sheet_w, .height = sheet_h};
+  res = lcd_st7735_draw_image(&ctx_, LCD_Point{.x = 50, .y = 40}, &sheet_bgr, src);
+  EXPECT_EQ(res.code, 0);
+  LCD_Image sheet_native{.data   = reinterpret_cast<const uint8_t *>(native.data()),
+                         .format = LCD_PixelFormatNative,
+                         .width  = sheet_w,
+                         .height = sheet_h};
+  res = lcd_st7735_draw_image(&ctx_, LCD_Point{.x = 100, .y = 40}, &sheet_native, src);
+  EXPECT_EQ(res.code, 0);
+
+  // The whole images through the contiguous buffer functions.
+  res = lcd_st7735_draw_image(&ctx_, LCD_Point{.x = 0, .y = 80}, &sheet_native,
+                              LCD_rectangle{.width = sheet_w, .height = sheet_h});
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_draw_bgr(&ctx_, LCD_rectangle{.origin = {.x = 80, .y = 80}, .width = sheet_w, .height = sheet_h},
+                            bgr.data());
+  EXPECT_EQ(res.code, 0);
+
+  // The source region must be inside the image.
+  src.origin.x = sheet_w - 8;
+  res          = lcd_st7735_draw_image(&ctx_, LCD_Point{.x = 0, .y = 0}, &sheet, src);
+  EXPECT_EQ(res.code, -1);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_image_scaled) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  // 8x8 pixel art in RGB565.
+  constexpr size_t art_size = 8;
+  const char *art[art_size] = {"..rrrr..", ".rrrrrr.", "rrwwrwwr", "rrwbrwbr",
+                               "rrrrrrrr", "rrrrrrrr", "rr.rr.rr", "r..r..r."};
+  std::vector<uint8_t> rgb565(art_size * art_size * 2);
+  for (size_t y = 0; y < art_size; ++y) {
+    for (size_t x = 0; x < art_size; ++x) {
+      uint16_t color = art[y][x] == 'r' ? 0xf800 : art[y][x] == 'w' ? 0xffff : art[y][x] == 'b' ? 0x001f : 0x07e0;
+      rgb565[(y * art_size + x) * 2]     = static_cast<uint8_t>(color);
+      rgb565[(y * art_size + x) * 2 + 1] = static_cast<uint8_t>(color >> 8);
+    }
+  }
+  LCD_Image image{.data = rgb565.data(), .format = LCD_PixelFormatRgb565, .width = art_size, .height = art_size};
+  LCD_rectangle whole{.width = art_size, .height = art_size};
+
+  uint32_t x = 0;
+  for (uint32_t scale = 1; scale <= 5; ++scale) {
+    LCD_rectangle rec{.origin = {.x = x, .y = 0}, .width = art_size * scale, .height = art_size * scale};
+    res = lcd_st7735_draw_image_scaled(&ctx_, rec, &image, whole);
+    EXPECT_EQ(res.code, 0);
+    x += rec.width + 2;
+  }
+
+  // Non integer stretch, decimation and a region of the image.
+  res = lcd_st7735_draw_image_scaled(&ctx_, LCD_rectangle{.origin = {.x = 0, .y = 50}, .width = 60, .height = 21},
+                                     &image, whole);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_draw_image_scaled(&ctx_, LCD_rectangle{.origin = {.x = 70, .y = 50}, .width = 4, .height = 4},
+                                     &image, whole);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_draw_image_scaled(&ctx_, LCD_rectangle{.origin = {.x = 80, .y = 50}, .width = 64, .height = 64},
+                                     &image, LCD_rectangle{.origin = {.x = 2, .y = 2}, .width = 4, .height = 2});
+  EXPECT_EQ(res.code, 0);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_text_scaled) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  res = lcd_st7735_set_font(&ctx_, &m5x7_16ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font_colors(&ctx_, 0x000000, 0x00ff00);
+  EXPECT_EQ(res.code, 0);
+
+  LCD_Point pos{.x = 0, .y = 0};
+  for (uint32_t scale = 1; scale <= 4; ++scale) {
+    res = lcd_st7735_puts_scaled(&ctx_, pos, "12:34", scale);
+    EXPECT_EQ(res.code, 5);
+    pos.y += m5x7_16ptFont.height * scale;
+  }
+
+  res = lcd_st7735_set_font(&ctx_, &lucidaConsole_10ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_putchar_scaled(&ctx_, LCD_Point{.x = 110, .y = 0}, 'A', 3);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_putchar_scaled(&ctx_, LCD_Point{.x = 110, .y = 50}, 'A', 0);
+  EXPECT_EQ(res.code, -1);
+  res = lcd_st7735_putchar_scaled(&ctx_, LCD_Point{.x = 150, .y = 50}, 'A', 3);
+  EXPECT_EQ(res.code, -1);
+  res = lcd_st7735_putchar_scaled(&ctx_, LCD_Point{.x = 110, .y = 120}, 'A', 3);
+  EXPECT_EQ(res.code, -1);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 0, .y = 120}, "A", 3);
+  EXPECT_EQ(res.code, -1);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_text_transparent) {
+  Result res = lcd_st7735_fill_gradient(
+      &ctx_, LCD_rectangle{.origin = {.x = 0, .y = 0}, .width = DisplayWidth, .height = DisplayHeight / 2},
+      LCD_GradientDiagonal, 0x0000ff, 0xffff00, false);
+  EXPECT_EQ(res.code, 0);
+  LCD_rectangle bottom{.origin = {.x = 0, .y = DisplayHeight / 2}, .width = DisplayWidth, .height = DisplayHeight / 2};
+  res = lcd_st7735_fill_rectangle(&ctx_, bottom, 0x404040);
+  EXPECT_EQ(res.code, 0);
+
+  res = lcd_st7735_set_font(&ctx_, &lucidaConsole_12ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font_colors(&ctx_, 0x404040, 0xffffff);
+  EXPECT_EQ(res.code, 0);
+
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextTransparent);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 4, .y = 4}, "Transparent");
+  EXPECT_EQ(res.code, 11);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 4, .y = 24}, "x2 text", 2);
+  EXPECT_EQ(res.code, 7);
+
+  // Over a plain background of the background color the result must be the same as the opaque text.
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextAuto);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 4, .y = 70}, "Auto #%&@");
+  EXPECT_EQ(res.code, 9);
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextOpaque);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 4, .y = 90}, "Auto #%&@");
+  EXPECT_EQ(res.code, 9);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, text_field) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font(&ctx_, &m5x7_16ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font_colors(&ctx_, 0xffffff, 0x000080);
+  EXPECT_EQ(res.code, 0);
+
+  St7735TextField counter, label;
+  res = lcd_st7735_text_field_init(&counter, LCD_Point{.x = 4, .y = 4}, 3);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_text_field_init(&label, LCD_Point{.x = 4, .y = 60}, 2);
+  EXPECT_EQ(res.code, 0);
+
+  // A counter ticking by one redraws a single character.
+  res = lcd_st7735_text_field_update(&ctx_, &counter, "123458");
+  EXPECT_EQ(res.code, 6);
+  res = lcd_st7735_text_field_update(&ctx_, &counter, "123459");
+  EXPECT_EQ(res.code, 1);
+  res = lcd_st7735_text_field_update(&ctx_, &counter, "123460");
+  EXPECT_EQ(res.code, 2);
+  res = lcd_st7735_text_field_update(&ctx_, &counter, "123460");
+  EXPECT_EQ(res.code, 0);
+
+  // With a proportional font the characters after a width change are shifted and redrawn, and the tail is cleaned.
+  res = lcd_st7735_text_field_update(&ctx_, &label, "Mill");
+  EXPECT_EQ(res.code, 4);
+  res = lcd_st7735_text_field_update(&ctx_, &label, "Mlil");
+  EXPECT_EQ(res.code, 2);
+  res = lcd_st7735_text_field_update(&ctx_, &label, "Wwwwww");
+  EXPECT_EQ(res.code, 6);
+  res = lcd_st7735_text_field_update(&ctx_, &label, "Wall");
+  EXPECT_EQ(res.code, 3);
+
+  // A new color redraws everything.
+  res = lcd_st7735_set_font_colors(&ctx_, 0xffffff, 0x800000);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_text_field_update(&ctx_, &counter, "123460");
+  EXPECT_EQ(res.code, 6);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_text_box) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  size_t width, height;
+  res = lcd_st7735_set_font(&ctx_, &lucidaConsole_10ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_measure_text(&ctx_, "Hello", &width, &height);
+  EXPECT_EQ(res.code, 0);
+  EXPECT_EQ(width, 5 * 8);
+  EXPECT_EQ(height, lucidaConsole_10ptFont.height);
+
+  res = lcd_st7735_set_font(&ctx_, &m5x7_16ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_measure_text(&ctx_, "Hello", &width, &height);
+  EXPECT_EQ(res.code, 0);
+  size_t expected = 0;
+  for (char c : std::string("Hello")) {
+    expected += m5x7_16ptFont.descriptor_table[c - m5x7_16ptFont.startCharacter].width;
+  }
+  EXPECT_EQ(width, expected);
+
+  const char *text = "The quick brown fox jumps over the lazy dog.\nSupercalifragilistic";
+  res              = lcd_st7735_set_font_colors(&ctx_, 0xe0e0ff, 0x000000);
+  EXPECT_EQ(res.code, 0);
+  LCD_rectangle box{.origin = {.x = 2, .y = 2}, .width = 74, .height = 60};
+  res = lcd_st7735_draw_text_box(&ctx_, box, text, LCD_AlignLeft);
+  EXPECT_GT(res.code, 0);
+
+  box.origin.x = 84;
+  res          = lcd_st7735_draw_text_box(&ctx_, box, text, LCD_AlignRight);
+  EXPECT_GT(res.code, 0);
+
+  // Lines beyond the box are clipped.
+  res = lcd_st7735_set_font(&ctx_, &lucidaConsole_10ptFont);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font_colors(&ctx_, 0xffffe0, 0x800000);
+  EXPECT_EQ(res.code, 0);
+  box  = LCD_rectangle{.origin = {.x = 2, .y = 66}, .width = 156, .height = 60};
+  text = "Centered\ntext box\n\nwith an empty line and clipped lines";
+  res  = lcd_st7735_draw_text_box(&ctx_, box, text, LCD_AlignCenter);
+  EXPECT_GT(res.code, 0);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_text_box_narrow) {
+  Result res = lcd_st7735_set_font(&ctx_, &lucidaConsole_10ptFont);
+  EXPECT_EQ(res.code, 0);
+
+  // Characters the font lacks are not drawn, so they don't count in the width.
+  size_t width, height;
+  res = lcd_st7735_measure_text(&ctx_, "A\xc2\xb5" "B\n", &width, &height);
+  EXPECT_EQ(res.code, 0);
+  EXPECT_EQ(width, 2 * 8);
+
+  // A box narrower than a glyph clips it, whatever the alignment.
+  res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  const LCD_TextAlign aligns[] = {LCD_AlignLeft, LCD_AlignCenter, LCD_AlignRight};
+  for (uint32_t i = 0; i < std::size(aligns); i++) {
+    LCD_rectangle box{.origin = {.x = 10 + 10 * i, .y = 10}, .width = 4, .height = lucidaConsole_10ptFont.height};
+    res = lcd_st7735_draw_text_box(&ctx_, box, "W", aligns[i]);
+    EXPECT_EQ(res.code, 1);
+
+    std::vector<uint8_t> rgb = mock_.simulator.rgb888();
+    size_t drawn             = 0;
+    for (size_t y = box.origin.y; y < box.origin.y + box.height; y++) {
+      for (size_t x = box.origin.x; x < box.origin.x + box.width; x++) {
+        drawn += rgb[(y * DisplayWidth + x) * 3] != 0xff;
+      }
+    }
+    EXPECT_GT(drawn, 0) << "alignment " << aligns[i];
+  }
+}
+
+TEST(TextTest, utf8_decode) {
+  const char *text = "A\xc2\xb5\xe2\x86\x90\xf0\x9f\x98\x80\xc0\xafZ\xe2\x86";
+  EXPECT_EQ(LCD_utf8_next(&text), 'A');
+  EXPECT_EQ(LCD_utf8_next(&text), 0xb5);                       // µ
+  EXPECT_EQ(LCD_utf8_next(&text), 0x2190);                     // ←
+  EXPECT_EQ(LCD_utf8_next(&text), 0x1f600);                    // 😀
+  EXPECT_EQ(LCD_utf8_next(&text), LCD_REPLACEMENT_CHARACTER);  // Overlong '/'
+  EXPECT_EQ(LCD_utf8_next(&text), 'Z');
+  EXPECT_EQ(LCD_utf8_next(&text), LCD_REPLACEMENT_CHARACTER);  // Truncated
+  EXPECT_EQ(LCD_utf8_next(&text), 0);
+  EXPECT_EQ(LCD_utf8_next(&text), 0);
+}
+
+TEST_F(st7735SimTest, draw_text_unicode) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  // Sparse font made of the m5x7 glyphs: digits, upper case letters and a few symbols borrowed from other glyphs.
+  auto index = [](char c) { return static_cast<unsigned short>(c - m5x7_16ptFont.startCharacter); };
+  const FontRange ranges[] = {
+      {.first = ' ', .count = 1, .index = index(' ')},  {.first = '0', .count = 10, .index = index('0')},
+      {.first = 'A', .count = 26, .index = index('A')}, {.first = 0xb0, .count = 1, .index = index('o')},
+      {.first = 0xb5, .count = 1, .index = index('u')}, {.first = 0x2190, .count = 1, .index = index('<')},
+      {.first = 0x2192, .count = 1, .index = index('>')},
+  };
+  Font sparse        = m5x7_16ptFont;
+  sparse.ranges      = ranges;
+  sparse.range_count = sizeof(ranges) / sizeof(ranges[0]);
+
+  EXPECT_EQ(LCD_font_glyph(&sparse, '5'), &m5x7_16ptFont.descriptor_table[index('5')]);
+  EXPECT_EQ(LCD_font_glyph(&sparse, 0x2192), &m5x7_16ptFont.descriptor_table[index('>')]);
+  EXPECT_EQ(LCD_font_glyph(&sparse, 'a'), nullptr);
+  EXPECT_EQ(LCD_font_glyph(&sparse, 0x2191), nullptr);
+  EXPECT_EQ(LCD_font_glyph(&m5x7_16ptFont, 0xb0), nullptr);
+
+  res = lcd_st7735_set_font(&ctx_, &sparse);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 0, .y = 0}, "25\u00b0C \u2192 77F", 2);
+  EXPECT_EQ(res.code, 10);
+  // Lower case letters are missing in the font and skipped.
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 0, .y = 20}, "\u2190 10 \u00b5Seconds", 2);
+  EXPECT_EQ(res.code, 7);
+
+  size_t width, height;
+  res = lcd_st7735_measure_text(&ctx_, "\u2190 10 \u00b5Seconds", &width, &height);
+  EXPECT_EQ(res.code, 0);
+  EXPECT_EQ(width, LCD_measure_text(&m5x7_16ptFont, "< 10 uS", SIZE_MAX));
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+// Copy of a font re-encoded with `FontEncodingPacked`.
+struct PackedFont {
+  std::vector<FontCharInfo> descriptors;
+  std::vector<uint8_t> bitmaps;
+  size_t source_size = 0;  // Size of the source bitmap array.
+  Font font;
+
+  explicit PackedFont(const Font &source) : font(source) {
+    for (size_t i = 0; i <= static_cast<size_t>(source.endCharacter - source.startCharacter); i++) {
+      const FontCharInfo &info = source.descriptor_table[i];
+      size_t stride            = (info.width + 7) / 8;
+      source_size              = std::max(source_size, info.position + stride * source.height);
+      auto pixel               = [&](size_t row, size_t column) {
+        return (source.bitmap_table[info.position + row * stride + column / 8] >> (column % 8)) & 0x01;
+      };
+      auto blank = [&](size_t row) {
+        for (size_t column = 0; column < info.width; column++) {
+          if (pixel(row, column)) return false;
+        }
+        return true;
+      };
+
+      size_t top = 0, bottom = source.height;
+      while (top < bottom && blank(top)) top++;
+      while (bottom > top && blank(bottom - 1)) bottom--;
+
+      descriptors.push_back({info.width, static_cast<unsigned short>(bitmaps.size())});
+      bitmaps.push_back(static_cast<uint8_t>(top));
+      bitmaps.push_back(static_cast<uint8_t>(bottom - top));
+      size_t bit = 0;
+      for (size_t row = top; row < bottom; row++) {
+        for (size_t column = 0; column < info.width; column++, bit++) {
+          if (bit % 8 == 0) bitmaps.push_back(0);
+          bitmaps.back() |= static_cast<uint8_t>(pixel(row, column) << (bit % 8));
+        }
+      }
+    }
+    font.descriptor_table = descriptors.data();
+    font.bitmap_table     = bitmaps.data();
+    font.encoding         = FontEncodingPacked;
+  }
+};
+
+TEST_F(st7735SimTest, draw_text_packed) {
+  // The packed fonts must draw exactly as the bitmap fonts they are made from.
+  for (const auto &[fonts, golden] : {std::pair{std::vector{&lucidaConsole_12ptFont, &lucidaConsole_10ptFont},
+                                                "./tests/golden_files/test_draw_text.png"},
+                                      std::pair{std::vector{&m5x7_16ptFont, &m3x6_16ptFont},
+                                                "./tests/golden_files/test_font_m5x7_16pt.png"}}) {
+    Result res = lcd_st7735_clean(&ctx_);
+    EXPECT_EQ(res.code, 0);
+
+    std::string ascii = "";
+    for (char c = ' '; c <= '~'; c++) {
+      ascii += c;
+    }
+    uint32_t bg(0xff), fg(0x00);
+    LCD_Point pos{.x = 0, .y = 0};
+    bool proportional = fonts[0] == &m5x7_16ptFont;
+
+    for (size_t i = 0; i < fonts.size(); i++) {
+      PackedFont packed(*fonts[i]);
+      EXPECT_LT(packed.bitmaps.size(), packed.source_size);
+      res = lcd_st7735_set_font(&ctx_, &packed.font);
+      EXPECT_EQ(res.code, 0);
+      size_t columns = DisplayWidth / (packed.font.descriptor_table->width + proportional);
+      size_t index   = 0;
+      do {
+        res = lcd_st7735_set_font_colors(&ctx_, bg, fg);
+        EXPECT_EQ(res.code, 0);
+        std::string print = ascii.substr(index, columns);
+        res               = lcd_st7735_puts(&ctx_, pos, print.c_str());
+        EXPECT_EQ(res.code, print.size());
+        index += columns;
+        pos.y += packed.font.height;
+        bg = bg << 8 | bg >> (32 - 8);  // Rotate left
+        fg = bg ^ 0xffffff;
+      } while (index < ascii.size() && (i == 0 || pos.y < DisplayHeight - packed.font.height));
+    }
+
+    std::string filename = make_temp_filename();
+    mock_.simulator.png(filename);
+    compare_img(filename, golden);
+  }
+}
+
+TEST_F(st7735SimTest, draw_text_wide) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  // The m5x7 glyphs stretched 4 times horizontally, up to 24 pixels wide with 3 bytes per row.
+  constexpr size_t stretch = 4;
+  const Font &source       = m5x7_16ptFont;
+  std::vector<FontCharInfo> descriptors;
+  std::vector<uint8_t> bitmaps;
+  for (size_t i = 0; i <= static_cast<size_t>(source.endCharacter - source.startCharacter); i++) {
+    const FontCharInfo &info = source.descriptor_table[i];
+    size_t width = info.width * stretch, stride = (width + 7) / 8;
+    descriptors.push_back({static_cast<unsigned char>(width), static_cast<unsigned short>(bitmaps.size())});
+    for (size_t row = 0; row < source.height; row++) {
+      uint32_t bits = 0;
+      for (size_t column = 0; column < width; column++) {
+        size_t x = column / stretch;
+        bits |= static_cast<uint32_t>((source.bitmap_table[info.position + row * ((info.width + 7) / 8) + x / 8] >>
+                                       (x % 8)) &
+                                      0x01)
+                << column;
+      }
+      for (size_t byte = 0; byte < stride; byte++) {
+        bitmaps.push_back(static_cast<uint8_t>(bits >> (8 * byte)));
+      }
+    }
+  }
+  Font wide             = source;
+  wide.descriptor_table = descriptors.data();
+  wide.bitmap_table     = bitmaps.data();
+  PackedFont packed(wide);
+
+  res = lcd_st7735_set_font(&ctx_, &wide);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font_colors(&ctx_, 0x000080, 0xffff00);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 0, .y = 0}, "Wide@");
+  EXPECT_EQ(res.code, 5);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 0, .y = 10}, "Hi!", 2);
+  EXPECT_EQ(res.code, 3);
+
+  res = lcd_st7735_set_font(&ctx_, &packed.font);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font_colors(&ctx_, 0x800000, 0x00ffff);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 0, .y = 30}, "Wide@");
+  EXPECT_EQ(res.code, 5);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 0, .y = 40}, "Hi!", 2);
+  EXPECT_EQ(res.code, 3);
+
+  // Text boxes and transparent text decode the same rows.
+  res = lcd_st7735_draw_text_box(&ctx_, LCD_rectangle{.origin = {.x = 0, .y = 60}, .width = 160, .height = 27},
+                                 "jog WMW", LCD_AlignCenter);
+  EXPECT_EQ(res.code, 6);  // Wrapped after "jog".
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextTransparent);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 0, .y = 100}, "Wide@");
+  EXPECT_EQ(res.code, 5);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+// Anti-aliased font made by averaging blocks of 2x2 pixels of the Lucida Console 12pt glyphs.
+struct GrayFont {
+  std::vector<FontCharInfo> descriptors;
+  std::vector<uint8_t> bitmaps;
+  Font font;
+
+  GrayFont(FontEncoding encoding) : font(lucidaConsole_12ptFont) {
+    const Font &source = lucidaConsole_12ptFont;
+    size_t bpp = encoding == FontEncodingGray4 ? 4 : 2, levels = (1u << bpp) - 1;
+    for (size_t i = 0; i <= static_cast<size_t>(source.endCharacter - source.startCharacter); i++) {
+      const FontCharInfo &info = source.descriptor_table[i];
+      size_t stride            = (info.width + 7) / 8;
+      size_t width             = (info.width + 1) / 2;
+      auto pixel               = [&](size_t row, size_t column) -> size_t {
+        if (column >= info.width) return 0;
+        return (source.bitmap_table[info.position + row * stride + column / 8] >> (column % 8)) & 0x01;
+      };
+      descriptors.push_back({static_cast<unsigned char>(width), static_cast<unsigned short>(bitmaps.size())});
+      for (size_t row = 0; row < source.height / 2; row++) {
+        size_t row_start = bitmaps.size();
+        bitmaps.resize(row_start + (width * bpp + 7) / 8);
+        for (size_t column = 0; column < width; column++) {
+          size_t count = pixel(row * 2, column * 2) + pixel(row * 2, column * 2 + 1) + pixel(row * 2 + 1, column * 2) +
+                         pixel(row * 2 + 1, column * 2 + 1);
+          size_t bit = column * bpp;
+          bitmaps[row_start + bit / 8] |= static_cast<uint8_t>((count * levels + 2) / 4 << (bit % 8));
+        }
+      }
+    }
+    font.height           = static_cast<unsigned char>(source.height / 2);
+    font.descriptor_table = descriptors.data();
+    font.bitmap_table     = bitmaps.data();
+    font.fixed_width      = static_cast<unsigned char>((source.fixed_width + 1) / 2);
+    font.encoding         = encoding;
+  }
+};
+
+TEST_F(st7735SimTest, draw_text_antialiased) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  GrayFont gray4(FontEncodingGray4), gray2(FontEncodingGray2);
+  LCD_Point pos{.x = 0, .y = 0};
+  for (const Font *font : {&gray4.font, &gray2.font}) {
+    res = lcd_st7735_set_font(&ctx_, font);
+    EXPECT_EQ(res.code, 0);
+    res = lcd_st7735_puts(&ctx_, pos, "Anti-aliased text 0123");
+    EXPECT_EQ(res.code, 22);
+    res = lcd_st7735_set_font_colors(&ctx_, 0x102040, 0xffc040);
+    EXPECT_EQ(res.code, 0);
+    res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = pos.x, .y = pos.y + 8}, "AaBb@&", 3);
+    EXPECT_EQ(res.code, 6);
+    LCD_rectangle box{.origin = {.x = 0, .y = pos.y + 32}, .width = DisplayWidth, .height = 16};
+    res = lcd_st7735_draw_text_box(&ctx_, box, "Text box, centered", LCD_AlignCenter);
+    EXPECT_EQ(res.code, 18);
+    pos.y += 56;
+  }
+
+  // Without a known background the transparent mode only draws the pixels with at least half coverage.
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextTransparent);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, pos, "Transparent");
+  EXPECT_EQ(res.code, 11);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, draw_text_rotated) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_set_font(&ctx_, &lucidaConsole_10ptFont);
+  EXPECT_EQ(res.code, 0);
+
+  // Axis titles along the left and right edges.
+  res = lcd_st7735_set_font_colors(&ctx_, 0xFFFFFF, 0x0000C0);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts_rotated(&ctx_, LCD_Point{.x = 0, .y = 10}, "Voltage (V)", LCD_TextUp);
+  EXPECT_EQ(res.code, 11);
+  LCD_Point right{.x = static_cast<uint32_t>(DisplayWidth - lucidaConsole_10ptFont.height), .y = 10};
+  res = lcd_st7735_puts_rotated(&ctx_, right, "Current (A)", LCD_TextDown);
+  EXPECT_EQ(res.code, 11);
+
+  // Characters past the bottom edge are dropped.
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextTransparent);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts_rotated(&ctx_, LCD_Point{.x = 40, .y = 60}, "Transparent", LCD_TextDown);
+  EXPECT_EQ(res.code, 8);
+  res = lcd_st7735_puts_rotated(&ctx_, LCD_Point{.x = 60, .y = 60}, "Transparent", LCD_TextUp);
+  EXPECT_EQ(res.code, 8);
+
+  // The address mode is restored for the horizontal text.
+  res = lcd_st7735_set_text_mode(&ctx_, LCD_TextOpaque);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 80, .y = 10}, "Level");
+  EXPECT_EQ(res.code, 5);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+#include <src/core/font_builder.hh>
+// Icons and digits of a thermostat display, 7 pixels high.
+static constexpr auto thermostat_data = FontBuilder::compile([] {
+  using Glyph = FontBuilder::Glyph<7>;
+  return std::array{
+      Glyph{U'1', {"..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###."}},
+      Glyph{U'2', {".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####"}},
+      Glyph{U'0', {".###.", "#...#", "#..##", "#.#.#", "##..#", "#...#", ".###."}},
+      Glyph{U'°', {".#.", "#.#", ".#.", "...", "...", "...", "..."}},
+      Glyph{U'C', {".###.", "#...#", "#....", "#....", "#....", "#...#", ".###."}},
+      Glyph{U' ', {"...", "...", "...", "...", "...", "...", "..."}},
+      Glyph{U'↑', {"...#...", "..###..", ".#.#.#.", "...#...", "...#...", "...#...", "......."}},
+      Glyph{U'↓', {".......", "...#...", "...#...", "...#...", ".#.#.#.", "..###..", "...#..."}},
+  };
+});
+static constexpr Font thermostat = thermostat_data.font();
+
+// The tables are constants, sorted by code point and in the smallest encoding.
+static_assert(thermostat.height == 7);
+static_assert(thermostat.range_count == 6);
+static_assert(thermostat.ranges[0].first == ' ' && thermostat.ranges[2].first == 'C');
+static_assert(thermostat.fixed_width == 0);
+static_assert(thermostat.encoding == FontEncodingPacked);
+static_assert(thermostat.descriptor_table[1].width == 5);  // '0'
+
+TEST_F(st7735SimTest, draw_text_font_builder) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+
+  res = lcd_st7735_set_font(&ctx_, &thermostat);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 4, .y = 4}, "21\u00b0C \u2191", 3);
+  EXPECT_EQ(res.code, 6);
+  res = lcd_st7735_set_font_colors(&ctx_, 0x000040, 0x40C0FF);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 4, .y = 40}, "20\u00b0C \u2193", 3);
+  EXPECT_EQ(res.code, 6);
+  // Characters missing in the font are skipped.
+  res = lcd_st7735_puts_scaled(&ctx_, LCD_Point{.x = 4, .y = 80}, "12.0 \u00b0F", 2);
+  EXPECT_EQ(res.code, 5);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, chunked_spi_write) {
+  // Commands, parameters and pixels split across writes must draw the same as whole writes.
+  std::vector<uint8_t> bgr(32 * 24 * 3);
+  for (size_t i = 0; i < bgr.size(); i++) {
+    bgr[i] = static_cast<uint8_t>(i * 7);
+  }
+  auto draw = [&]() {
+    lcd_st7735_startup(&ctx_);
+    Result res = lcd_st7735_clean(&ctx_);
+    EXPECT_EQ(res.code, 0);
+    res = lcd_st7735_fill_rectangle(&ctx_, LCD_rectangle{.origin = {.x = 3, .y = 5}, .width = 41, .height = 17},
+                                    0x3060F0);
+    EXPECT_EQ(res.code, 0);
+    res = lcd_st7735_draw_bgr(&ctx_, LCD_rectangle{.origin = {.x = 51, .y = 3}, .width = 32, .height = 24}, bgr.data());
+    EXPECT_EQ(res.code, 0);
+    lcd_st7735_set_font(&ctx_, &lucidaConsole_12ptFont);
+    lcd_st7735_set_font_colors(&ctx_, 0x00FF00, 0x101010);
+    res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 2, .y = 40}, "Chunked writes");
+    EXPECT_EQ(res.code, 14);
+    res = lcd_st7735_puts_rotated(&ctx_, LCD_Point{.x = 140, .y = 10}, "Rotated", LCD_TextDown);
+    EXPECT_EQ(res.code, 7);
+  };
+
+  draw();
+  std::string whole = make_temp_filename();
+  mock_.simulator.png(whole);
+
+  for (size_t max_chunk : {1, 2, 7}) {
+    mock_.max_chunk = max_chunk;
+    draw();
+    std::string filename = make_temp_filename();
+    mock_.simulator.png(filename);
+    compare_img(filename, whole);
+  }
+}
+
+TEST_F(st7735SimTest, bus_time) {
+  // 1us per byte at 8MHz, 500ns per write and no pin overhead.
+  mock_.simulator.set_timing(Simulator::Timing{.sck_hz = 8'000'000, .write_ns = 500});
+  mock_.simulator.reset_bus_time();
+
+  Result res = lcd_st7735_fill_rectangle(
+      &ctx_, LCD_rectangle{.origin = {.x = 0, .y = 0}, .width = DisplayWidth, .height = DisplayHeight}, 0x123456);
+  EXPECT_EQ(res.code, 0);
+  uint64_t frame = mock_.simulator.end_frame();
+
+  const Simulator::BusTime &ramwr = mock_.simulator.bus_time(ST7735_RAMWR);
+  EXPECT_EQ(ramwr.count, 1);
+  EXPECT_EQ(ramwr.bytes, 1 + DisplayWidth * DisplayHeight * sizeof(uint16_t));
+  EXPECT_EQ(ramwr.ns, ramwr.bytes * 1000 + ramwr.writes * 500);
+
+  uint64_t total = 0;
+  for (size_t command = 0; command <= UINT8_MAX; command++) {
+    total += mock_.simulator.bus_time(static_cast<uint8_t>(command)).ns;
+  }
+  EXPECT_EQ(total, frame);
+  EXPECT_EQ(mock_.simulator.frame_ns(), std::vector<uint64_t>{frame});
+
+  // Several commands in one write are one write of the first command.
+  const uint8_t commands[] = {ST7735_NORON, ST7735_INVOFF};
+  mock_.simulator.dc_pin(Simulator::PinLevel::Low);
+  mock_.simulator.spi_write(commands);
+  EXPECT_EQ(mock_.simulator.bus_time(ST7735_NORON).writes, 1);
+  EXPECT_EQ(mock_.simulator.bus_time(ST7735_NORON).ns, 1000 + 500);
+  EXPECT_EQ(mock_.simulator.bus_time(ST7735_INVOFF).writes, 0);
+  EXPECT_EQ(mock_.simulator.bus_time(ST7735_INVOFF).count, 1);
+  EXPECT_EQ(mock_.simulator.bus_time(ST7735_INVOFF).ns, 1000);
+
+  // The controller delays are accounted after the commands.
+  lcd_st7735_startup(&ctx_);
+  EXPECT_GE(mock_.simulator.bus_time(ST7735_SWRESET).ns, 120'000'000);
+  EXPECT_EQ(mock_.simulator.end_frame(), mock_.simulator.bus_time_ns() - frame);
+}
+
+TEST_F(st7735SimTest, overdraw) {
+  Result res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  mock_.simulator.end_frame();
+
+  // Overlapping rectangles of 60x40, consecutive ones overlap on 40x25 pixels and three of them on 20x10 pixels.
+  for (uint32_t i = 0; i < 4; i++) {
+    res = lcd_st7735_fill_rectangle(
+        &ctx_, LCD_rectangle{.origin = {.x = 10 + i * 20, .y = 10 + i * 15}, .width = 60, .height = 40}, 0x00FF00);
+    EXPECT_EQ(res.code, 0);
+  }
+  mock_.simulator.end_frame();
+
+  const Simulator::Overdraw &overdraw = mock_.simulator.overdraw();
+  EXPECT_EQ(overdraw.written, 4 * 60 * 40);
+  EXPECT_EQ(overdraw.unique, 4 * 60 * 40 - 3 * 40 * 25);
+  EXPECT_EQ(overdraw.max, 3);
+
+  std::string filename = make_temp_filename();
+  mock_.simulator.overdraw_png(filename);
+  compare_img(filename, GET_GOLDEN_FILE());
+}
+
+TEST_F(st7735SimTest, counters) {
+  St7735Counters counters;
+#if LCD_ST7735_COUNTERS
+  EXPECT_EQ(lcd_st7735_reset_counters(&ctx_).code, ErrorOk);
+  mock_.simulator.reset_bus_time();
+
+  lcd_st7735_clean(&ctx_);
+  lcd_st7735_draw_pixel(&ctx_, LCD_Point{.x = 3, .y = 4}, 0xFF0000);
+  lcd_st7735_draw_horizontal_line(&ctx_, LCD_Line{.origin = {.x = 0, .y = 20}, .length = 50}, 0x00FF00);
+  lcd_st7735_fill_gradient(&ctx_, LCD_rectangle{.origin = {.x = 10, .y = 30}, .width = 40, .height = 20},
+                           LCD_GradientHorizontal, 0x000000, 0xFFFFFF, false);
+  lcd_st7735_set_font(&ctx_, &lucidaConsole_10ptFont);
+  lcd_st7735_puts(&ctx_, LCD_Point{.x = 0, .y = 60}, "Hi");
+  lcd_st7735_reset(&ctx_, false);
+
+  EXPECT_EQ(lcd_st7735_get_counters(&ctx_, &counters).code, ErrorOk);
+  EXPECT_EQ(counters.windows, 4 + 2);  // One per call and one per character.
+  EXPECT_EQ(counters.delay_ms, 120);
+  EXPECT_EQ(counters.pixels[St7735ApiFill], DisplayWidth * DisplayHeight);
+  EXPECT_EQ(counters.pixels[St7735ApiPixel], 1);
+  EXPECT_EQ(counters.pixels[St7735ApiLine], 50);
+  EXPECT_EQ(counters.pixels[St7735ApiRegion], 40 * 20);
+  EXPECT_EQ(counters.pixels[St7735ApiText], LCD_measure_text(ctx_.parent.font, "Hi", 2) * ctx_.parent.font->height);
+  EXPECT_EQ(counters.pixels[St7735ApiImage], 0);
+
+  // The bus seen by the simulator.
+  uint64_t bytes = 0, commands = 0;
+  for (size_t command = 0; command <= UINT8_MAX; command++) {
+    bytes += mock_.simulator.bus_time(static_cast<uint8_t>(command)).bytes;
+    commands += mock_.simulator.bus_time(static_cast<uint8_t>(command)).count;
+  }
+  EXPECT_EQ(counters.bytes, bytes);
+  EXPECT_EQ(counters.commands, commands);
+
+  EXPECT_EQ(lcd_st7735_reset_counters(&ctx_).code, ErrorOk);
+  EXPECT_EQ(lcd_st7735_get_counters(&ctx_, &counters).code, ErrorOk);
+  EXPECT_EQ(counters.bytes, 0);
+#else
+  EXPECT_EQ(lcd_st7735_get_counters(&ctx_, &counters).code, ErrorOperationFailed);
+  EXPECT_EQ(counters.bytes, 0);
+#endif
+}
+
+#ifdef __linux__
+#include <src/linux/lcd_profile.h>
+TEST_F(st7735SimTest, profile) {
+  // The simulated bus time is the clock, so the latencies are the time the bus would take.
+  mock_.simulator.set_timing(Simulator::Timing{.sck_hz = 8'000'000, .write_ns = 500});
+  LCD_Profile profile;
+  EXPECT_EQ(LCD_profile_init(&profile, &interface_).code, ErrorOk);
+  profile.clock_ns      = [](void *user) {
+    return static_cast<MockInterfaceSimulator *>(user)->simulator.bus_time_ns();
+  };
+  profile.user          = &mock_;
+  ctx_.parent.interface = &profile.interface;
+
+  LCD_rectangle small{.origin = {.x = 10, .y = 10}, .width = 10, .height = 10};
+  uint64_t start = mock_.simulator.bus_time_ns();
+  lcd_st7735_fill_rectangle(&ctx_, small, 0xFF0000);
+  uint64_t small_ns = mock_.simulator.bus_time_ns() - start;
+  start             = mock_.simulator.bus_time_ns();
+  lcd_st7735_clean(&ctx_);
+  uint64_t clean_ns = mock_.simulator.bus_time_ns() - start;
+
+  // 97 more small fills and another full screen one, so the 99th percentile is a full screen fill.
+  for (int i = 0; i < 97; i++) {
+    lcd_st7735_fill_rectangle(&ctx_, small, 0x00FF00);
+  }
+  lcd_st7735_clean(&ctx_);
+
+  LCD_ProfileStats stats;
+  EXPECT_EQ(LCD_profile_stats(&profile, St7735OpFillRectangle, &stats).code, ErrorOk);
+  EXPECT_EQ(stats.count, 100);
+  EXPECT_EQ(stats.total_ns, 98 * small_ns + 2 * clean_ns);
+  EXPECT_GE(stats.p50_ns, small_ns);
+  EXPECT_LE(stats.p50_ns, small_ns + small_ns / 8);
+  EXPECT_EQ(stats.p99_ns, clean_ns);
+  EXPECT_EQ(stats.max_ns, clean_ns);
+
+  // The clean includes its fill.
+  EXPECT_EQ(LCD_profile_stats(&profile, St7735OpClean, &stats).code, ErrorOk);
+  EXPECT_EQ(stats.count, 2);
+  EXPECT_EQ(stats.max_ns, clean_ns);
+  EXPECT_EQ(LCD_profile_stats(&profile, St7735OpPuts, &stats).code, ErrorOk);
+  EXPECT_EQ(stats.count, 0);
+
+  // A NULL context is refused before the hooks are called.
+  size_t width, height;
+  EXPECT_EQ(lcd_st7735_check_frame_buffer_resolution(nullptr, &width, &height).code, ErrorNullArgs);
+  EXPECT_EQ(lcd_st7735_check_frame_buffer_resolution(&ctx_, nullptr, &height).code, ErrorNullArgs);
+  EXPECT_EQ(LCD_profile_stats(&profile, St7735OpCheckFrameBufferResolution, &stats).code, ErrorOk);
+  EXPECT_EQ(stats.count, 0);
+
+  char *report  = nullptr;
+  size_t length = 0;
+  FILE *file    = open_memstream(&report, &length);
+  LCD_profile_report(&profile, file, lcd_st7735_op_name);
+  fclose(file);
+  EXPECT_NE(std::string(report).find("fill_rectangle"), std::string::npos);
+  EXPECT_EQ(std::string(report).find("puts"), std::string::npos);
+  free(report);
+}
+#endif
+
+#include <src/core/lcd_trace.h>
+TEST_F(st7735SimTest, trace) {
+  struct Recording {
+    uint64_t now = 0;
+    std::vector<uint8_t> data;
+  } recording;
+  auto clock_ns = [](void *user) { return static_cast<Recording *>(user)->now += 100; };
+  auto flush    = [](void *user, const uint8_t *data, size_t length) {
+    std::vector<uint8_t> &trace = static_cast<Recording *>(user)->data;
+    trace.insert(trace.end(), data, data + length);
+  };
+
+  // A buffer of a few records, flushed to the vector when it is full.
+  LCD_Trace trace;
+  uint8_t buffer[LCD_TRACE_HEADER_SIZE + 3 * LCD_TRACE_RECORD_SIZE];
+  Result res = LCD_trace_init(&trace, &interface_, buffer, sizeof(buffer), clock_ns, flush, &recording);
+  EXPECT_EQ(res.code, 0);
+  lcd_st7735_init(&ctx_, &trace.interface);
+  mock_.simulator.reset_bus_time();
+
+  res = lcd_st7735_startup(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_fill_rectangle(&ctx_, LCD_rectangle{.origin = {.x = 4, .y = 4}, .width = 20, .height = 10}, 0xFF);
+  EXPECT_EQ(res.code, 0);
+  LCD_trace_flush(&trace);
+  EXPECT_EQ(trace.dropped, 0);
+
+  const std::vector<uint8_t> &data = recording.data;
+  ASSERT_EQ((data.size() - LCD_TRACE_HEADER_SIZE) % LCD_TRACE_RECORD_SIZE, 0);
+  EXPECT_EQ(std::string(data.begin(), data.begin() + 4), "LCDT");
+  EXPECT_EQ(data[4], LCD_TRACE_VERSION);
+
+  auto le = [&](size_t offset, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+      value |= static_cast<uint64_t>(data[offset + i]) << (8 * i);
+    }
+    return value;
+  };
+  size_t spi_bytes = 0, spi_writes = 0, delays = 0;
+  uint64_t last_start = 0;
+  for (size_t offset = LCD_TRACE_HEADER_SIZE; offset < data.size(); offset += LCD_TRACE_RECORD_SIZE) {
+    EXPECT_GT(le(offset + 8, 8), last_start);
+    EXPECT_EQ(le(offset + 16, 4), 100);
+    last_start = le(offset + 8, 8);
+    if (data[offset] == LCD_TraceSpiWrite) {
+      spi_bytes += le(offset + 4, 4);
+      spi_writes++;
+    }
+    delays += data[offset] == LCD_TraceDelay;
+  }
+  size_t bus_bytes = 0, bus_writes = 0;
+  for (size_t command = 0; command <= UINT8_MAX; command++) {
+    bus_bytes += mock_.simulator.bus_time(static_cast<uint8_t>(command)).bytes;
+    bus_writes += mock_.simulator.bus_time(static_cast<uint8_t>(command)).writes;
+  }
+  EXPECT_EQ(spi_bytes, bus_bytes);
+  EXPECT_EQ(spi_writes, bus_writes);
+  EXPECT_GT(delays, 0);
+
+  // Without flush the records that don't fit are dropped.
+  res = LCD_trace_init(&trace, &interface_, buffer, sizeof(buffer), clock_ns, NULL, &recording);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_fill_rectangle(&ctx_, LCD_rectangle{.origin = {.x = 4, .y = 4}, .width = 20, .height = 10}, 0xFF);
+  EXPECT_EQ(res.code, 0);
+  EXPECT_EQ(trace.length, sizeof(buffer));
+  EXPECT_GT(trace.dropped, 0);
+
+  // A buffer that can't hold a record is refused.
+  res = LCD_trace_init(&trace, &interface_, buffer, LCD_TRACE_HEADER_SIZE + LCD_TRACE_RECORD_SIZE - 1, clock_ns, NULL,
+                       &recording);
+  EXPECT_EQ(res.code, ErrorOperationFailed);
+}
+
+#include <simulator/st7735/replay.hh>
+TEST_F(st7735SimTest, trace_replay) {
+  std::vector<uint8_t> data;
+  auto clock_ns = [](void *user) -> uint64_t { return 0; };
+  auto flush    = [](void *user, const uint8_t *chunk, size_t length) {
+    std::vector<uint8_t> &trace = *static_cast<std::vector<uint8_t> *>(user);
+    trace.insert(trace.end(), chunk, chunk + length);
+  };
+
+  // The buffer is smaller than most pixel writes, which are flushed in pieces.
+  LCD_Trace trace;
+  uint8_t buffer[64];
+  Result res = LCD_trace_init(&trace, &interface_, buffer, sizeof(buffer), clock_ns, flush, &data);
+  EXPECT_EQ(res.code, 0);
+  trace.capture_data = true;
+  lcd_st7735_init(&ctx_, &trace.interface);
+
+  res = lcd_st7735_startup(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  LCD_trace_mark_frame(&trace);
+  lcd_st7735_set_font(&ctx_, &lucidaConsole_12ptFont);
+  res = lcd_st7735_puts(&ctx_, LCD_Point{.x = 4, .y = 4}, "Replayed");
+  EXPECT_EQ(res.code, 8);
+  res = lcd_st7735_puts_rotated(&ctx_, LCD_Point{.x = 140, .y = 10}, "Rotated", LCD_TextDown);
+  EXPECT_EQ(res.code, 7);
+  LCD_trace_mark_frame(&trace);
+  LCD_trace_flush(&trace);
+
+  std::string error;
+  auto records = Simulator::parse_trace(data, error);
+  ASSERT_TRUE(records) << error;
+
+  auto replayed = std::make_unique<Simulator::St7735<DisplayWidth, DisplayHeight>>();
+  size_t frames = 0;
+  Simulator::replay_trace(*replayed, *records, [&]() { frames++; });
+  EXPECT_EQ(frames, 2);
+
+  std::string expected = make_temp_filename(), filename = make_temp_filename();
+  mock_.simulator.png(expected);
+  replayed->png(filename);
+  compare_img(filename, expected);
+
+  // A truncated trace is rejected.
+  data.pop_back();
+  EXPECT_FALSE(Simulator::parse_trace(data, error));
+}
+
+TEST_F(st7735SimTest, trace_replay_without_data) {
+  std::vector<uint8_t> data;
+  auto clock_ns = [](void *user) -> uint64_t { return 0; };
+  auto flush    = [](void *user, const uint8_t *chunk, size_t length) {
+    std::vector<uint8_t> &trace = *static_cast<std::vector<uint8_t> *>(user);
+    trace.insert(trace.end(), chunk, chunk + length);
+  };
+
+  LCD_Trace trace;
+  uint8_t buffer[256];
+  Result res = LCD_trace_init(&trace, &interface_, buffer, sizeof(buffer), clock_ns, flush, &data);
+  EXPECT_EQ(res.code, 0);
+  lcd_st7735_init(&ctx_, &trace.interface);
+  res = lcd_st7735_clean(&ctx_);
+  EXPECT_EQ(res.code, 0);
+  LCD_trace_flush(&trace);
+
+  std::string error;
+  auto records = Simulator::parse_trace(data, error);
+  ASSERT_TRUE(records) << error;
+
+  // The writes without data are skipped, they neither draw nor take bus time.
+  auto replayed = std::make_unique<Simulator::St7735<DisplayWidth, DisplayHeight>>();
+  replayed->set_timing(Simulator::Timing{.sck_hz = 8'000'000, .write_ns = 500});
+  EXPECT_EQ(Simulator::replay_trace(*replayed, *records), 0);
+  EXPECT_EQ(replayed->bus_time_ns(), 0);
+  for (size_t command = 0; command <= UINT8_MAX; command++) {
+    EXPECT_EQ(replayed->bus_time(static_cast<uint8_t>(command)).writes, 0);
+  }
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
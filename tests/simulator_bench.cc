@@ -0,0 +1,94 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Throughput of the simulator for full screen RAMWR, in frames per second, and the bus time each frame would take on
+// the hardware with the default timing, a 15MHz SPI clock.
+//
+// Usage: st7735_driver_simulator_bench [frames]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "../src/st7735/lcd_st7735.h"
+#include <simulator/st7735/controller.hh>
+
+constexpr size_t DisplayWidth  = 160;
+constexpr size_t DisplayHeight = 128;
+
+using Display = Simulator::St7735<DisplayWidth, DisplayHeight>;
+
+static uint32_t spi_write(void *handle, uint8_t *data, size_t len) {
+  static_cast<Display *>(handle)->spi_write({data, len});
+  return len;
+}
+
+static uint32_t gpio_write(void *handle, bool cs, bool dc) {
+  Display *display = static_cast<Display *>(handle);
+  display->dc_pin(dc ? Simulator::PinLevel::High : Simulator::PinLevel::Low);
+  display->cs_pin(cs ? Simulator::PinLevel::High : Simulator::PinLevel::Low);
+  return 0;
+}
+
+static uint32_t reset(void *handle) { return 0; }
+static void set_pwm(void *handle, uint8_t pwm) {}
+static void sleep_ms(void *handle, uint32_t ms) {}
+
+// Run `draw` for each frame and print the frame rate and the simulated bus time per frame.
+static void run(Display &display, const char *name, size_t frames, const std::function<void(size_t)> &draw) {
+  display.reset_bus_time();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t frame = 0; frame < frames; frame++) {
+    draw(frame);
+    display.end_frame();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  double bytes  = static_cast<double>(frames * DisplayWidth * DisplayHeight * sizeof(uint16_t));
+  double bus_us = static_cast<double>(display.bus_time_ns()) / frames / 1e3;
+  std::printf("%-24s %8zu frames %10.1f frames/s %8.1f MB/s %10.1f simulated us/frame\n", name, frames,
+              frames / elapsed.count(), bytes / elapsed.count() / 1e6, bus_us);
+}
+
+int main(int argc, char **argv) {
+  size_t frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+
+  static Display display;
+  LCD_Interface interface = {
+      .handle            = &display,
+      .spi_write         = spi_write,
+      .spi_read          = NULL,
+      .gpio_write        = gpio_write,
+      .reset             = reset,
+      .set_backlight_pwm = set_pwm,
+      .timer_delay       = sleep_ms,
+  };
+  St7735Context ctx;
+  lcd_st7735_init(&ctx, &interface);
+  lcd_st7735_startup(&ctx);
+
+  // Whole frame sent in a single `spi_write`.
+  std::vector<uint16_t> pixels(DisplayWidth * DisplayHeight);
+  LCD_Image image = {
+      .data   = reinterpret_cast<const uint8_t *>(pixels.data()),
+      .format = LCD_PixelFormatNative,
+      .width  = DisplayWidth,
+      .height = DisplayHeight,
+      .stride = 0,
+  };
+  LCD_rectangle screen = {.origin = {.x = 0, .y = 0}, .width = DisplayWidth, .height = DisplayHeight};
+  run(display, "draw_image (1 write)", frames, [&](size_t frame) {
+    std::fill(pixels.begin(), pixels.end(), static_cast<uint16_t>(frame * 0x0841));
+    lcd_st7735_draw_image(&ctx, screen.origin, &image, screen);
+  });
+
+  // One `spi_write` per row.
+  run(display, "fill_rectangle (rows)", frames,
+      [&](size_t frame) { lcd_st7735_fill_rectangle(&ctx, screen, static_cast<uint32_t>(frame * 0x010101)); });
+
+  return 0;
+}
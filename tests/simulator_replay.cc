@@ -0,0 +1,92 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Replay of a bus trace recorded with `LCD_trace_init` and `capture_data` into the simulator, as fast as it goes.
+//
+// Usage: st7735_driver_simulator_replay trace [--png final.png] [--frames prefix] [--repeat count]
+//
+//   --png     Save the display at the end of the trace.
+//   --frames  Save the display at each frame marker, as prefix_0000.png, prefix_0001.png, ...
+//   --repeat  Replay the trace this many times, to measure the throughput.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <simulator/st7735/replay.hh>
+
+constexpr size_t DisplayWidth  = 160;
+constexpr size_t DisplayHeight = 128;
+
+using Display = Simulator::St7735<DisplayWidth, DisplayHeight>;
+
+int main(int argc, char **argv) {
+  std::string trace_file, png, frames_prefix;
+  size_t repeat = 1;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--png") == 0 && i + 1 < argc) {
+      png = argv[++i];
+    } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      frames_prefix = argv[++i];
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::strtoul(argv[++i], nullptr, 10);
+    } else {
+      trace_file = argv[i];
+    }
+  }
+  if (trace_file.empty()) {
+    std::fprintf(stderr, "Usage: %s trace [--png final.png] [--frames prefix] [--repeat count]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream file(trace_file, std::ios::binary);
+  std::vector<uint8_t> trace{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  std::string error;
+  auto records = Simulator::parse_trace(trace, error);
+  if (!records) {
+    std::fprintf(stderr, "%s: %s\n", trace_file.c_str(), error.c_str());
+    return 1;
+  }
+
+  static Display display;
+  size_t frame = 0;
+  std::chrono::duration<double> saving{0};
+  auto save_frame = [&]() {
+    if (!frames_prefix.empty()) {
+      auto start = std::chrono::steady_clock::now();
+      display.png(std::format("{}_{:04}.png", frames_prefix, frame));
+      saving += std::chrono::steady_clock::now() - start;
+    }
+    frame++;
+  };
+
+  // The time spent saving the frames is not part of the throughput.
+  size_t bytes = 0;
+  auto start   = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeat; i++) {
+    bytes += Simulator::replay_trace(display, *records, save_frame);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start - saving;
+
+  if (!png.empty()) {
+    display.png(png);
+  }
+
+  size_t missing = 0;
+  for (const auto &record : *records) {
+    missing += record.event == LCD_TraceSpiWrite && record.data.size() != record.value;
+  }
+  if (missing) {
+    std::fprintf(stderr, "warning: %zu writes without data were skipped, record with capture_data\n", missing);
+  }
+  std::printf("%zu records x %zu, %zu frames, %zu bytes in %.3f ms: %.1f MB/s\n", records->size(), repeat, frame,
+              bytes, elapsed.count() * 1e3, bytes / elapsed.count() / 1e6);
+  return 0;
+}
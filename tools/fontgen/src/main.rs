@@ -5,7 +5,43 @@
 use std::path::PathBuf;
 
 use anyhow::{ensure, Result};
-use clap::Parser;
+use clap::{Parser, ValueEnum};
+
+/// Layout of the glyphs in the bitmap array, see `FontEncoding` in font.h.
+#[derive(Clone, Copy, PartialEq, ValueEnum)]
+enum Encoding {
+    /// One byte per row.
+    Bitmap,
+    /// Blank rows at the top and bottom trimmed and the remaining rows packed without padding.
+    Packed,
+    /// Anti-aliased with 4 levels of coverage.
+    Gray2,
+    /// Anti-aliased with 16 levels of coverage.
+    Gray4,
+}
+
+impl Encoding {
+    fn bits_per_pixel(self) -> usize {
+        match self {
+            Encoding::Bitmap | Encoding::Packed => 1,
+            Encoding::Gray2 => 2,
+            Encoding::Gray4 => 4,
+        }
+    }
+}
+
+/// Pack pixel values of `bpp` bits, the first one in the least significant bits of the first byte.
+fn pack(levels: impl Iterator<Item = u8>, bpp: usize) -> Vec<u8> {
+    let mut bytes: Vec<u8> = Vec::new();
+    for (i, level) in levels.enumerate() {
+        let bit = i * bpp;
+        if bit % 8 == 0 {
+            bytes.push(0);
+        }
+        *bytes.last_mut().unwrap() |= level << (bit % 8);
+    }
+    bytes
+}
 
 #[derive(Parser)]
 struct Args {
@@ -16,6 +52,25 @@ struct Args {
 
     #[arg(long, default_value = "")]
     font_name: String,
+
+    /// Characters to include in addition to the printable ASCII ones, e.g. "°µ←↑→↓".
+    #[arg(long, default_value = "")]
+    extra_chars: String,
+
+    #[arg(long, value_enum, default_value = "bitmap")]
+    encoding: Encoding,
+}
+
+/// Group the sorted characters in ranges of consecutive code points: (first, count, index of the first).
+fn code_point_ranges(chars: &[char]) -> Vec<(u32, usize, usize)> {
+    let mut ranges: Vec<(u32, usize, usize)> = Vec::new();
+    for (i, &c) in chars.iter().enumerate() {
+        match ranges.last_mut() {
+            Some((first, count, _)) if *first + *count as u32 == c as u32 => *count += 1,
+            _ => ranges.push((c as u32, 1, i)),
+        }
+    }
+    ranges
 }
 
 fn main() -> Result<()> {
@@ -25,9 +80,16 @@ fn main() -> Result<()> {
     let font = fontdue::Font::from_bytes(font, fontdue::FontSettings::default())
         .map_err(|err| anyhow::anyhow!("{}", err))?;
 
-    // First rasterize all printable ASCII characters.
+    // The printable ASCII characters followed by the extra ones, sorted by code point.
+    let mut chars: Vec<char> = (' '..='~').collect();
+    chars.extend(args.extra_chars.chars());
+    chars.sort();
+    chars.dedup();
+    let ranges = code_point_ranges(&chars);
+
+    // First rasterize all characters.
     let mut rasterization = Vec::new();
-    for c in ' '..='~' {
+    for &c in &chars {
         let (metrics, bitmap) = font.rasterize(c, args.font_size);
         ensure!(
             metrics.xmin >= 0,
@@ -49,14 +111,29 @@ fn main() -> Result<()> {
 
     let max_width = rasterization
         .iter()
-        .map(|(metrics, _)| metrics.width)
+        .map(|(metrics, _)| metrics.advance_width as usize)
         .max()
         .unwrap();
     let max_height = (max_y - min_y) as usize;
 
+    // Monospace fonts are flagged with their width, so text can be measured without looking up each character.
+    let first_advance = rasterization[0].0.advance_width as usize;
+    let fixed_width = if rasterization
+        .iter()
+        .all(|(metrics, _)| metrics.advance_width as usize == first_advance)
+    {
+        first_advance
+    } else {
+        0
+    };
+
+    ensure!(
+        max_width <= 32,
+        "this tool cannot generate font with width greater than 32 pixels"
+    );
     ensure!(
-        max_width <= 8,
-        "this tool cannot generate font with width greater than 8 pixels"
+        max_height <= 255,
+        "this tool cannot generate font with height greater than 255 pixels"
     );
 
     println!("#include <font.h>");
@@ -71,44 +148,108 @@ fn main() -> Result<()> {
         args.font_size
     );
 
-    for (i, c) in (' '..='~').enumerate() {
-        if i != 0 {
-            println!();
-        }
-
-        let (metrics, bitmap) = &rasterization[i];
-        println!(
-            "    // @{} '{}' ({} pixels wide)",
-            c as usize, c, metrics.advance_width as usize
-        );
+    // Rows of each character, top down, as a level per pixel with the pixel art used as comment.
+    let bpp = args.encoding.bits_per_pixel();
+    let max_level = (1u32 << bpp) - 1;
+    let mut glyphs: Vec<Vec<(Vec<u8>, String)>> = Vec::new();
+    for (metrics, bitmap) in &rasterization {
+        // Only the pixels within the advance width are drawn.
+        let width = metrics.advance_width as usize;
+        let mut rows = Vec::new();
         for y in (min_y..max_y).rev() {
             // The y axis goes bottom up but bitmap is top down.
             // Convert the index
             let y_offset = metrics.height as i32 - 1 - (y - metrics.ymin);
             if y_offset < 0 || y_offset >= metrics.height as i32 {
-                println!("    0x00,  //");
+                rows.push((vec![0; width], String::new()));
                 continue;
             }
 
             let y_offset = y_offset as usize;
 
-            let mut row = 0u8;
+            let mut levels = Vec::new();
             let mut pixel_art = String::new();
-            for x in 0..metrics.width {
-                let pixel = bitmap[y_offset as usize * metrics.width + x as usize];
-                // dbg!(pixel);
-                if pixel > 128 {
-                    row |= 1 << x;
-                    pixel_art.push('#');
+            for x in 0..width {
+                let pixel = if x < metrics.width {
+                    bitmap[y_offset * metrics.width + x] as u32
                 } else {
-                    pixel_art.push(' ');
-                }
+                    0
+                };
+                let level = if bpp == 1 {
+                    (pixel > 128) as u32
+                } else {
+                    (pixel * max_level + 127) / 255
+                };
+                levels.push(level as u8);
+                pixel_art.push(b" .:+#"[(level * 4 / max_level) as usize] as char);
             }
 
-            println!("    0x{:02x},  // {}", row, pixel_art.trim_end());
+            rows.push((levels, pixel_art.trim_end().to_string()));
         }
+        glyphs.push(rows);
     }
 
+    let mut positions = Vec::new();
+    let mut size = 0;
+    for (i, &c) in chars.iter().enumerate() {
+        if i != 0 {
+            println!();
+        }
+
+        let (metrics, _) = &rasterization[i];
+        let width = metrics.advance_width as usize;
+        let rows = &glyphs[i];
+        println!("    // @{} '{}' ({} pixels wide)", c as usize, c, width);
+        positions.push(size);
+
+        if args.encoding != Encoding::Packed {
+            // Each row takes (width * bpp + 7) / 8 bytes, the leftmost pixel in the least significant bits of the first.
+            for (levels, pixel_art) in rows {
+                let bytes: Vec<String> = pack(levels.iter().copied(), bpp)
+                    .iter()
+                    .map(|byte| format!("0x{:02x},", byte))
+                    .collect();
+                println!(
+                    "{}",
+                    format!("    {}  // {}", bytes.join(" "), pixel_art).trim_end()
+                );
+            }
+            size += rows.len() * ((width * bpp + 7) / 8);
+            continue;
+        }
+
+        let blank = |(levels, _): &&(Vec<u8>, String)| levels.iter().all(|&level| level == 0);
+        let top = rows.iter().take_while(blank).count();
+        let bottom = rows.len() - rows.iter().rev().take_while(blank).count();
+        let bottom = bottom.max(top);
+        for (_, pixel_art) in &rows[top..bottom] {
+            println!("    //{}", pixel_art);
+        }
+        println!(
+            "    0x{:02x}, 0x{:02x},  // {} blank rows, {} rows",
+            top,
+            bottom - top,
+            top,
+            bottom - top
+        );
+
+        let bytes = pack(
+            rows[top..bottom]
+                .iter()
+                .flat_map(|(levels, _)| levels.iter().copied()),
+            1,
+        );
+        for line in bytes.chunks(12) {
+            let line: Vec<String> = line.iter().map(|byte| format!("0x{:02x},", byte)).collect();
+            println!("    {}", line.join(" "));
+        }
+        size += 2 + bytes.len();
+    }
+    ensure!(
+        size <= u16::MAX as usize,
+        "this tool cannot generate font with bitmaps larger than 65535 bytes"
+    );
+
     println!("}};");
     println!();
     println!(
@@ -120,23 +261,85 @@ fn main() -> Result<()> {
         heck::AsLowerCamelCase(&args.font_name),
         args.font_size
     );
-    for (i, c) in (' '..='~').enumerate() {
+    for (i, &c) in chars.iter().enumerate() {
         let (metrics, _) = &rasterization[i];
         println!(
             "{}",
             format!(
                 "    {{ {}, {} }},  // '{}'",
-                metrics.advance_width as usize,
-                max_height * i,
-                c
+                metrics.advance_width as usize, positions[i], c
             )
             .trim_end()
         );
     }
 
-    println!(
-        "}};
+    println!("}};");
 
+    // Fonts with characters outside the ASCII range are indexed by code point ranges.
+    let has_ranges = ranges.len() > 1;
+    if has_ranges {
+        println!();
+        println!(
+            "// Code point ranges for {} {}pt",
+            args.font_name, args.font_size
+        );
+        println!(
+            "const FontRange {}_{}ptRanges[] = {{",
+            heck::AsLowerCamelCase(&args.font_name),
+            args.font_size
+        );
+        for (first, count, index) in &ranges {
+            println!("    {{ 0x{:04x}, {}, {} }},", first, count, index);
+        }
+        println!("}};");
+    }
+
+    let bitmap_size: usize = rasterization
+        .iter()
+        .map(|(metrics, _)| max_height * ((metrics.advance_width as usize + 7) / 8))
+        .sum();
+    eprintln!(
+        "{} {}pt: {} bytes of bitmaps, {} bytes in the bitmap encoding",
+        args.font_name, args.font_size, size, bitmap_size
+    );
+
+    let ranges_fields = if has_ranges {
+        format!(
+            "
+    {name_camel}_{size}ptRanges,       //  Code point ranges
+    {count},                             //  Number of code point ranges",
+            name_camel = heck::AsLowerCamelCase(&args.font_name),
+            size = args.font_size,
+            count = ranges.len(),
+        )
+    } else {
+        "
+    0,                                //  Code point ranges
+    0,                                //  Number of code point ranges"
+            .to_string()
+    };
+
+    let encoding_field = match args.encoding {
+        Encoding::Bitmap => {
+            "
+    FontEncodingBitmap,               //  Bitmap encoding"
+        }
+        Encoding::Packed => {
+            "
+    FontEncodingPacked,               //  Bitmap encoding"
+        }
+        Encoding::Gray2 => {
+            "
+    FontEncodingGray2,                //  Bitmap encoding"
+        }
+        Encoding::Gray4 => {
+            "
+    FontEncodingGray4,                //  Bitmap encoding"
+        }
+    };
+
+    println!(
+        "
 // Font information for {name} {size}pt
 const Font {name_camel}_{size}ptFont = {{
     {height},                             //  Character height
@@ -144,11 +347,15 @@ const Font {name_camel}_{size}ptFont = {{
     '~',                            //  End character
     {name_camel}_{size}ptDescriptors,  //  Character descriptor array
     {name_camel}_{size}ptBitmaps,      //  Character bitmap array
+    {fixed_width},                             //  Fixed width, 0 if proportional{ranges_fields}{encoding_field}
 }};",
         name = args.font_name,
         name_camel = heck::AsLowerCamelCase(&args.font_name),
         size = args.font_size,
         height = max_height,
+        fixed_width = fixed_width,
+        ranges_fields = ranges_fields,
+        encoding_field = encoding_field,
     );
 
     Ok(())
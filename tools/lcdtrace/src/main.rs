@@ -0,0 +1,172 @@
+// Copyright (c) 2025 Douglas Reis.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+//! Convert a trace recorded with `LCD_trace_init` (see src/core/lcd_trace.h) to the Chrome trace event format, which
+//! can be opened in chrome://tracing or https://ui.perfetto.dev.
+
+use std::error::Error;
+use std::fmt::Write as _;
+use std::io::Write as _;
+use std::path::PathBuf;
+
+use clap::Parser;
+
+const MAGIC: &[u8] = b"LCDT";
+const VERSION: u32 = 1;
+const HEADER_SIZE: usize = 8;
+const RECORD_SIZE: usize = 20;
+const FLAG_DATA: u8 = 0x01;
+
+#[derive(Parser)]
+struct Args {
+    /// Binary trace.
+    trace: PathBuf,
+
+    /// JSON file to be written, the standard output if not given.
+    #[arg(long)]
+    output: Option<PathBuf>,
+}
+
+/// A call to the interface, see `LCD_TraceEvent`.
+struct Record {
+    event: u8,
+    value: u32,
+    start_ns: u64,
+    duration_ns: u32,
+}
+
+fn le(bytes: &[u8]) -> u64 {
+    bytes
+        .iter()
+        .rev()
+        .fold(0, |value, &byte| value << 8 | byte as u64)
+}
+
+fn parse(data: &[u8]) -> Result<Vec<Record>, String> {
+    if data.len() < HEADER_SIZE || &data[..4] != MAGIC {
+        return Err("not a trace, the magic is missing".to_string());
+    }
+    let version = le(&data[4..8]) as u32;
+    if version != VERSION {
+        return Err(format!("unsupported trace version {}", version));
+    }
+    let mut records = Vec::new();
+    let mut offset = HEADER_SIZE;
+    while offset < data.len() {
+        if data.len() - offset < RECORD_SIZE {
+            eprintln!("warning: the trace ends with a truncated record");
+            break;
+        }
+        let record = &data[offset..offset + RECORD_SIZE];
+        let value = le(&record[4..8]) as u32;
+        records.push(Record {
+            event: record[0],
+            value,
+            start_ns: le(&record[8..16]),
+            duration_ns: le(&record[16..20]) as u32,
+        });
+        // The bytes written, if they were captured, are not part of the timeline.
+        offset += RECORD_SIZE;
+        if record[1] & FLAG_DATA != 0 {
+            offset += value as usize;
+        }
+    }
+    Ok(records)
+}
+
+/// Nanoseconds as the microseconds used by the trace event format.
+fn micros(ns: u64) -> String {
+    format!("{}.{:03}", ns / 1000, ns % 1000)
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+    let records = parse(&std::fs::read(&args.trace)?)?;
+
+    // Every call is a complete event on a single track, so the calls made inside the driver functions line up. The
+    // bytes written are also shown as a counter, whose slope is the bus throughput.
+    let mut events = Vec::new();
+    let mut spi_bytes = 0u64;
+    let mut spi_ns = 0u64;
+    for record in &records {
+        let (name, args) = match record.event {
+            0 => ("spi_write", format!("{{\"bytes\": {}}}", record.value)),
+            1 => ("spi_read", format!("{{\"bytes\": {}}}", record.value)),
+            2 => (
+                "gpio_write",
+                format!(
+                    "{{\"cs\": {}, \"dc\": {}}}",
+                    record.value & 1,
+                    record.value >> 1 & 1
+                ),
+            ),
+            3 => ("reset", "{}".to_string()),
+            4 => (
+                "set_backlight_pwm",
+                format!("{{\"pwm\": {}}}", record.value),
+            ),
+            5 => ("timer_delay", format!("{{\"ms\": {}}}", record.value)),
+            6 => {
+                events.push(format!(
+                    "{{\"name\": \"frame\", \"ph\": \"i\", \"s\": \"g\", \"ts\": {}, \"pid\": 1, \"tid\": 1}}",
+                    micros(record.start_ns)
+                ));
+                continue;
+            }
+            event => (
+                "unknown",
+                format!("{{\"event\": {}, \"value\": {}}}", event, record.value),
+            ),
+        };
+        events.push(format!(
+            "{{\"name\": \"{}\", \"ph\": \"X\", \"ts\": {}, \"dur\": {}, \"pid\": 1, \"tid\": 1, \"args\": {}}}",
+            name,
+            micros(record.start_ns),
+            micros(record.duration_ns as u64),
+            args
+        ));
+
+        if record.event <= 1 {
+            spi_bytes += record.value as u64;
+            spi_ns += record.duration_ns as u64;
+            events.push(format!(
+                "{{\"name\": \"spi bytes\", \"ph\": \"C\", \"ts\": {}, \"pid\": 1, \"args\": {{\"bytes\": {}}}}}",
+                micros(record.start_ns + record.duration_ns as u64),
+                spi_bytes
+            ));
+        }
+    }
+
+    let mut json = String::from("{\"traceEvents\": [\n");
+    for (i, event) in events.iter().enumerate() {
+        let separator = if i + 1 < events.len() { "," } else { "" };
+        writeln!(json, "  {}{}", event, separator)?;
+    }
+    json.push_str("], \"displayTimeUnit\": \"ns\"}\n");
+
+    match &args.output {
+        Some(path) => std::fs::write(path, json)?,
+        None => std::io::stdout().write_all(json.as_bytes())?,
+    }
+
+    // Share of the traced time spent in the SPI calls.
+    let span_ns = match (records.first(), records.last()) {
+        (Some(first), Some(last)) => last.start_ns + last.duration_ns as u64 - first.start_ns,
+        _ => 0,
+    };
+    eprintln!(
+        "{} calls over {} us, {} SPI bytes in {} us ({:.1}% of the time)",
+        records.len(),
+        micros(span_ns),
+        spi_bytes,
+        micros(spi_ns),
+        if span_ns > 0 {
+            spi_ns as f64 * 100.0 / span_ns as f64
+        } else {
+            0.0
+        }
+    );
+
+    Ok(())
+}